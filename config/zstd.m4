@@ -0,0 +1,23 @@
+dnl A function to check whether zstd should be used to compress and
+dnl decompress debug sections.  zstd is used if the header and library
+dnl are found, unless configured with --without-zstd.  ZSTD_LIBS is
+dnl set to the libraries to link against, and HAVE_ZSTD is defined.
+
+AC_DEFUN([AC_ZSTD],
+[
+  AC_ARG_WITH(zstd,
+  [AS_HELP_STRING([--with-zstd],
+		  [support zstd compressed debug sections (default=auto)])],
+  [], [with_zstd=auto])
+  ZSTD_LIBS=
+  if test "$with_zstd" != no; then
+    AC_CHECK_HEADER(zstd.h,
+      [AC_CHECK_LIB(zstd, ZSTD_decompress,
+	[ZSTD_LIBS=-lzstd
+	 AC_DEFINE(HAVE_ZSTD, 1, [Define to 1 if zstd is enabled.])])])
+    if test "$with_zstd" = yes && test -z "$ZSTD_LIBS"; then
+      AC_MSG_ERROR([--with-zstd was given, but libzstd was not found])
+    fi
+  fi
+  AC_SUBST(ZSTD_LIBS)
+])
@@ -54,6 +54,27 @@ struct bstring
 };
 
 
+/* Statistics gathered from one or more bcaches, see
+   bcache::gather_statistics.  */
+
+struct bcache_statistics
+{
+  unsigned long unique_count = 0;
+  long total_count = 0;
+  long unique_size = 0;
+  long total_size = 0;
+  long structure_size = 0;
+  unsigned long expand_count = 0;
+  unsigned long expand_hash_count = 0;
+  unsigned long half_hash_miss_count = 0;
+
+  /* The length of each hash chain, including the empty ones.  */
+  std::vector<int> chain_length;
+  /* The size of each unique entry.  */
+  std::vector<int> entry_size;
+};
+
+
 /* Growing the bcache's hash table.  */
 
 /* If the average chain length grows beyond this, then we want to
@@ -142,7 +163,15 @@ bcache::expand_hash_table ()
 const void *
 bcache::insert (const void *addr, int length, bool *added)
 {
-  unsigned long full_hash;
+  return insert_hashed (addr, length, this->hash (addr, length), added);
+}
+
+/* See bcache.h.  */
+
+const void *
+bcache::insert_hashed (const void *addr, int length,
+		       unsigned long full_hash, bool *added)
+{
   unsigned short half_hash;
   int hash_index;
   struct bstring *s;
@@ -167,8 +196,6 @@ bcache::insert (const void *addr, int length, bool *added)
   m_total_count++;
   m_total_size += length;
 
-  full_hash = this->hash (addr, length);
-
   half_hash = (full_hash >> 16);
   hash_index = full_hash % m_num_buckets;
 
@@ -251,97 +278,100 @@ print_percentage (int portion, int total)
 }
 
 
-/* Print statistics on BCACHE's memory usage and efficacity at
-   eliminating duplication.  NAME should describe the kind of data
-   BCACHE holds.  Statistics are printed using `gdb_printf' and
-   its ilk.  */
+/* Add this bcache's statistics to STATS.  */
+
 void
-bcache::print_statistics (const char *type)
+bcache::gather_statistics (bcache_statistics &stats) const
+{
+  stats.unique_count += m_unique_count;
+  stats.total_count += m_total_count;
+  stats.unique_size += m_unique_size;
+  stats.total_size += m_total_size;
+  stats.structure_size += m_structure_size;
+  stats.expand_count += m_expand_count;
+  stats.expand_hash_count += m_expand_hash_count;
+  stats.half_hash_miss_count += m_half_hash_miss_count;
+
+  for (unsigned int b = 0; b < m_num_buckets; b++)
+    {
+      int chain_length = 0;
+
+      for (struct bstring *s = m_bucket[b]; s; s = s->next)
+	{
+	  chain_length++;
+	  stats.entry_size.push_back (s->length);
+	}
+
+      stats.chain_length.push_back (chain_length);
+    }
+}
+
+/* Print STATS, gathered from N_SHARDS bcaches holding data of kind
+   TYPE.  */
+
+static void
+print_bcache_statistics (const char *type, bcache_statistics &stats,
+			 int n_shards = 1)
 {
   int occupied_buckets;
   int max_chain_length;
   int median_chain_length;
   int max_entry_size;
   int median_entry_size;
+  std::vector<int> &chain_length = stats.chain_length;
+  std::vector<int> &entry_size = stats.entry_size;
+  int num_buckets = chain_length.size ();
 
-  /* Count the number of occupied buckets, tally the various string
-     lengths, and measure chain lengths.  */
-  {
-    unsigned int b;
-    int *chain_length = XCNEWVEC (int, m_num_buckets + 1);
-    int *entry_size = XCNEWVEC (int, m_unique_count + 1);
-    int stringi = 0;
+  gdb_assert (entry_size.size () == stats.unique_count);
 
-    occupied_buckets = 0;
+  occupied_buckets = std::count_if (chain_length.begin (),
+				    chain_length.end (),
+				    [] (int length) { return length > 0; });
 
-    for (b = 0; b < m_num_buckets; b++)
-      {
-	struct bstring *s = m_bucket[b];
-
-	chain_length[b] = 0;
-
-	if (s)
-	  {
-	    occupied_buckets++;
-	    
-	    while (s)
-	      {
-		gdb_assert (b < m_num_buckets);
-		chain_length[b]++;
-		gdb_assert (stringi < m_unique_count);
-		entry_size[stringi++] = s->length;
-		s = s->next;
-	      }
-	  }
-      }
-
-    /* To compute the median, we need the set of chain lengths
-       sorted.  */
-    std::sort (chain_length, chain_length + m_num_buckets);
-    std::sort (entry_size, entry_size + m_unique_count);
-
-    if (m_num_buckets > 0)
-      {
-	max_chain_length = chain_length[m_num_buckets - 1];
-	median_chain_length = chain_length[m_num_buckets / 2];
-      }
-    else
-      {
-	max_chain_length = 0;
-	median_chain_length = 0;
-      }
-    if (m_unique_count > 0)
-      {
-	max_entry_size = entry_size[m_unique_count - 1];
-	median_entry_size = entry_size[m_unique_count / 2];
-      }
-    else
-      {
-	max_entry_size = 0;
-	median_entry_size = 0;
-      }
+  /* To compute the median, we need the set of chain lengths
+     sorted.  */
+  std::sort (chain_length.begin (), chain_length.end ());
+  std::sort (entry_size.begin (), entry_size.end ());
 
-    xfree (chain_length);
-    xfree (entry_size);
-  }
+  if (num_buckets > 0)
+    {
+      max_chain_length = chain_length[num_buckets - 1];
+      median_chain_length = chain_length[num_buckets / 2];
+    }
+  else
+    {
+      max_chain_length = 0;
+      median_chain_length = 0;
+    }
+  if (stats.unique_count > 0)
+    {
+      max_entry_size = entry_size[stats.unique_count - 1];
+      median_entry_size = entry_size[stats.unique_count / 2];
+    }
+  else
+    {
+      max_entry_size = 0;
+      median_entry_size = 0;
+    }
 
   gdb_printf (_("  M_Cached '%s' statistics:\n"), type);
-  gdb_printf (_("    Total object count:  %ld\n"), m_total_count);
-  gdb_printf (_("    Unique object count: %lu\n"), m_unique_count);
+  gdb_printf (_("    Total object count:  %ld\n"), stats.total_count);
+  gdb_printf (_("    Unique object count: %lu\n"), stats.unique_count);
   gdb_printf (_("    Percentage of duplicates, by count: "));
-  print_percentage (m_total_count - m_unique_count, m_total_count);
+  print_percentage (stats.total_count - stats.unique_count,
+		    stats.total_count);
   gdb_printf ("\n");
 
-  gdb_printf (_("    Total object size:   %ld\n"), m_total_size);
-  gdb_printf (_("    Unique object size:  %ld\n"), m_unique_size);
+  gdb_printf (_("    Total object size:   %ld\n"), stats.total_size);
+  gdb_printf (_("    Unique object size:  %ld\n"), stats.unique_size);
   gdb_printf (_("    Percentage of duplicates, by size:  "));
-  print_percentage (m_total_size - m_unique_size, m_total_size);
+  print_percentage (stats.total_size - stats.unique_size, stats.total_size);
   gdb_printf ("\n");
 
   gdb_printf (_("    Max entry size:     %d\n"), max_entry_size);
   gdb_printf (_("    Average entry size: "));
-  if (m_unique_count > 0)
-    gdb_printf ("%ld\n", m_unique_size / m_unique_count);
+  if (stats.unique_count > 0)
+    gdb_printf ("%ld\n", stats.unique_size / stats.unique_count);
   else
     /* i18n: "Average entry size: (not applicable)".  */
     gdb_printf (_("(not applicable)\n"));    
@@ -350,36 +380,53 @@ bcache::print_statistics (const char *type)
 
   gdb_printf (_("    \
 Total memory used by bcache, including overhead: %ld\n"),
-	      m_structure_size);
+	      stats.structure_size);
   gdb_printf (_("    Percentage memory overhead: "));
-  print_percentage (m_structure_size - m_unique_size, m_unique_size);
+  print_percentage (stats.structure_size - stats.unique_size,
+		    stats.unique_size);
   gdb_printf (_("    Net memory savings:         "));
-  print_percentage (m_total_size - m_structure_size, m_total_size);
+  print_percentage (stats.total_size - stats.structure_size,
+		    stats.total_size);
   gdb_printf ("\n");
 
   gdb_printf (_("    Hash table size:           %3d\n"), 
-	      m_num_buckets);
+	      num_buckets);
   gdb_printf (_("    Hash table expands:        %lu\n"),
-	      m_expand_count);
+	      stats.expand_count);
   gdb_printf (_("    Hash table hashes:         %lu\n"),
-	      m_total_count + m_expand_hash_count);
+	      stats.total_count + stats.expand_hash_count);
   gdb_printf (_("    Half hash misses:          %lu\n"),
-	      m_half_hash_miss_count);
+	      stats.half_hash_miss_count);
   gdb_printf (_("    Hash table population:     "));
-  print_percentage (occupied_buckets, m_num_buckets);
+  print_percentage (occupied_buckets, num_buckets);
   gdb_printf (_("    Median hash chain length:  %3d\n"),
 	      median_chain_length);
   gdb_printf (_("    Average hash chain length: "));
-  if (m_num_buckets > 0)
-    gdb_printf ("%3lu\n", m_unique_count / m_num_buckets);
+  if (num_buckets > 0)
+    gdb_printf ("%3lu\n", stats.unique_count / num_buckets);
   else
     /* i18n: "Average hash chain length: (not applicable)".  */
     gdb_printf (_("(not applicable)\n"));
   gdb_printf (_("    Maximum hash chain length: %3d\n"), 
 	      max_chain_length);
+  if (n_shards > 1)
+    gdb_printf (_("    Number of shards:          %3d\n"), n_shards);
   gdb_printf ("\n");
 }
 
+/* Print statistics on BCACHE's memory usage and efficacity at
+   eliminating duplication.  NAME should describe the kind of data
+   BCACHE holds.  Statistics are printed using `gdb_printf' and
+   its ilk.  */
+void
+bcache::print_statistics (const char *type)
+{
+  bcache_statistics stats;
+
+  gather_statistics (stats);
+  print_bcache_statistics (type, stats);
+}
+
 int
 bcache::memory_used ()
 {
@@ -388,4 +435,49 @@ bcache::memory_used ()
   return obstack_memory_used (&m_cache);
 }
 
+/* See bcache.h.  */
+
+const void *
+concurrent_bcache::insert (const void *addr, int length, bool *added)
+{
+  unsigned long full_hash = fast_hash (addr, length, 0);
+
+  /* Each shard uses FULL_HASH for its own buckets and half hashes, so
+     mix it before picking the shard, so that the strings of one shard
+     are still spread over all of its buckets.  */
+  unsigned int index = (((full_hash * 0x9e3779b9UL) & 0xffffffffUL)
+			>> (32 - 4));
+  gdb_static_assert (n_shards == 1 << 4);
+
+  shard &s = m_shards[index];
+#if CXX_STD_THREAD
+  std::lock_guard<std::mutex> guard (s.lock);
+#endif
+  return s.cache.insert_hashed (addr, length, full_hash, added);
+}
+
+/* See bcache.h.  */
+
+void
+concurrent_bcache::print_statistics (const char *type)
+{
+  bcache_statistics stats;
+
+  for (shard &s : m_shards)
+    s.cache.gather_statistics (stats);
+  print_bcache_statistics (type, stats, n_shards);
+}
+
+/* See bcache.h.  */
+
+int
+concurrent_bcache::memory_used ()
+{
+  int result = 0;
+
+  for (shard &s : m_shards)
+    result += s.cache.memory_used ();
+  return result;
+}
+
 } /* namespace gdb */
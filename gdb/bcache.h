@@ -136,9 +136,14 @@
   
 */
 
+#if CXX_STD_THREAD
+#include <mutex>
+#endif
+
 namespace gdb {
 
 struct bstring;
+struct bcache_statistics;
 
 struct bcache
 {
@@ -154,6 +159,13 @@ struct bcache
 
   const void *insert (const void *addr, int length, bool *added = nullptr);
 
+  /* Like insert, but FULL_HASH is the hash of the LENGTH bytes at
+     ADDR, as returned by the hash method.  */
+
+  const void *insert_hashed (const void *addr, int length,
+			     unsigned long full_hash,
+			     bool *added = nullptr);
+
   /* Print statistics on this bcache's memory usage and efficacity at
      eliminating duplication.  TYPE should be a string describing the
      kind of data this bcache holds.  Statistics are printed using
@@ -203,6 +215,52 @@ struct bcache
 
   /* Expand the hash table.  */
   void expand_hash_table ();
+
+  /* Add this bcache's counters, chain lengths and entry sizes to
+     STATS.  */
+  void gather_statistics (bcache_statistics &stats) const;
+
+  friend struct concurrent_bcache;
+};
+
+/* A bcache that can be used from several threads at once.
+
+   The strings are spread over a fixed number of shards according to
+   their hash, each shard being an independent bcache, with its own
+   hash table and obstack, protected by its own lock.  Threads
+   inserting strings that fall in different shards do not contend,
+   and a shard's hash table is expanded without stopping the others.
+
+   The hash and compare functions are those of the base bcache, so
+   this can't be used for caches that override them.  */
+
+struct concurrent_bcache
+{
+  /* See bcache::insert.  This can be called from any thread.  */
+
+  const void *insert (const void *addr, int length, bool *added = nullptr);
+
+  /* See bcache::print_statistics.  The statistics of all the shards
+     are combined.  This must not be called while other threads are
+     inserting strings.  */
+  void print_statistics (const char *type);
+  int memory_used ();
+
+  /* The number of shards.  This is a power of 2.  */
+  static constexpr int n_shards = 16;
+
+private:
+
+  /* One shard of the cache.  */
+  struct shard
+  {
+    bcache cache;
+#if CXX_STD_THREAD
+    std::mutex lock;
+#endif
+  };
+
+  shard m_shards[n_shards];
 };
 
 } /* namespace gdb */
@@ -83,6 +83,15 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The maximum number of lines read ahead when a cache miss follows the
+   previous fill, i.e., when the memory looks like it is being walked
+   sequentially.  The read-ahead starts at one line, and doubles with
+   each further sequential miss, up to this.  Zero disables it.  */
+
+#define DCACHE_DEFAULT_PREFETCH 8
+
+static unsigned dcache_prefetch = DCACHE_DEFAULT_PREFETCH;
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -98,6 +107,7 @@ struct dcache_block
 
   CORE_ADDR addr;		/* address of data */
   int refs;			/* # hits */
+  bool prefetched;		/* read ahead, and not used yet */
   gdb_byte data[1];		/* line_size bytes at given address */
 };
 
@@ -120,6 +130,29 @@ struct dcache_struct
   /* The process target of last inferior to use the cache or
      nullptr.  */
   process_stratum_target *proc_target;
+
+  /* The first and last lines of the last fill, if HAVE_LAST_FILL, to
+     detect sequential accesses.  */
+  bool have_last_fill;
+  CORE_ADDR last_fill_lo;
+  CORE_ADDR last_fill_hi;
+
+  /* The number of lines to read ahead on the next sequential miss, and
+     in which direction: 1 to read the following lines, -1 to read the
+     preceding ones.  */
+  unsigned readahead;
+  int direction;
+
+  /* Statistics, printed by "info dcache".  They are kept across
+     invalidations.  HITS and MISSES count the accesses to a byte, and
+     whether its line was in the cache.  The other counters count
+     lines.  */
+  ULONGEST hits;
+  ULONGEST misses;
+  ULONGEST fills;
+  ULONGEST prefetched;
+  ULONGEST prefetch_used;
+  ULONGEST prefetch_wasted;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
@@ -239,6 +272,8 @@ invalidate_block (struct dcache_block *block, void *param)
 {
   DCACHE *dcache = (DCACHE *) param;
 
+  if (block->prefetched)
+    dcache->prefetch_wasted++;
   splay_tree_remove (dcache->tree, (splay_tree_key) block->addr);
   append_block (&dcache->freelist, block);
 }
@@ -254,6 +289,9 @@ dcache_invalidate (DCACHE *dcache)
   dcache->size = 0;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->have_last_fill = false;
+  dcache->readahead = 0;
+  dcache->direction = 0;
 
   if (dcache->line_size != dcache_line_size)
     {
@@ -275,6 +313,8 @@ dcache_invalidate_line (DCACHE *dcache, CORE_ADDR addr)
 
   if (db)
     {
+      if (db->prefetched)
+	dcache->prefetch_wasted++;
       splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
       remove_block (&dcache->oldest, db);
       append_block (&dcache->freelist, db);
@@ -363,6 +403,8 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
       /* Evict the least recently allocated line.  */
       db = dcache->oldest;
       remove_block (&dcache->oldest, db);
+      if (db->prefetched)
+	dcache->prefetch_wasted++;
 
       splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
     }
@@ -381,6 +423,7 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 
   db->addr = MASK (dcache, addr);
   db->refs = 0;
+  db->prefetched = false;
 
   /* Put DB at the end of the list, it's the newest.  */
   append_block (&dcache->oldest, db);
@@ -391,6 +434,167 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
+/* Fill the lines of DCACHE covering the LEN bytes at MEMADDR that are
+   not cached yet, with a single batched target read.  Runs of
+   consecutive missing lines are read with one request each.  The
+   lines that don't overlap the DEMAND_LEN bytes at DEMAND_ADDR are
+   read ahead, and counted as prefetched.  Lines that can't be read
+   completely are left out of the cache, dcache_peek_byte will retry
+   the ones that are needed one at a time.  */
+
+static void
+dcache_read_lines (DCACHE *dcache, CORE_ADDR memaddr, ULONGEST len,
+		   CORE_ADDR demand_addr, ULONGEST demand_len)
+{
+  CORE_ADDR line = MASK (dcache, memaddr);
+  CORE_ADDR end = memaddr + len;
+
+  /* Don't evict lines we are filling.  */
+  unsigned max_lines = dcache_size / 2;
+
+  std::vector<CORE_ADDR> lines;
+
+  for (; line < end && lines.size () < max_lines;
+       line += dcache->line_size)
+    {
+      /* Lines wrapping around the address space, or crossing memory
+	 regions, are left to dcache_read_line.  */
+      if (line + dcache->line_size < line)
+	break;
+
+      splay_tree_node node = splay_tree_lookup (dcache->tree,
+						(splay_tree_key) line);
+      if (node != nullptr)
+	continue;
+
+      struct mem_region *region = lookup_mem_region (line);
+      if (region->attrib.mode == MEM_WO
+	  || (region->hi != 0 && line + dcache->line_size > region->hi))
+	continue;
+
+      lines.push_back (line);
+    }
+
+  /* A single line is read just as well by dcache_read_line.  */
+  if (lines.size () < 2)
+    return;
+
+  /* Group consecutive lines, so that each run can be read with a
+     single request.  The data is then copied to the lines.  */
+  std::vector<memory_batch_request> requests;
+  std::vector<gdb::byte_vector> buffers;
+  for (size_t i = 0; i < lines.size (); )
+    {
+      size_t j = i + 1;
+      while (j < lines.size ()
+	     && lines[j] == lines[j - 1] + dcache->line_size)
+	j++;
+
+      ULONGEST run_len = (j - i) * dcache->line_size;
+      buffers.emplace_back (run_len);
+      requests.push_back ({lines[i], buffers.back ().data (), run_len, 0});
+      i = j;
+    }
+
+  target_read_raw_memory_batch (requests);
+
+  dcache->fills++;
+  for (const memory_batch_request &req : requests)
+    for (ULONGEST off = 0;
+	 off + dcache->line_size <= req.xfered_len;
+	 off += dcache->line_size)
+      {
+	CORE_ADDR addr = req.addr + off;
+	struct dcache_block *db = dcache_alloc (dcache, addr);
+
+	memcpy (db->data, req.buf + off, dcache->line_size);
+	if (addr + dcache->line_size <= demand_addr
+	    || addr >= demand_addr + demand_len)
+	  {
+	    db->prefetched = true;
+	    dcache->prefetched++;
+	  }
+      }
+}
+
+/* Handle a miss for the line containing ADDR: fill it, and if the
+   access looks sequential, read ahead the following (or preceding)
+   lines with the same request.  Return the filled line, or NULL if it
+   couldn't be read.  */
+
+static struct dcache_block *
+dcache_miss (DCACHE *dcache, CORE_ADDR addr)
+{
+  CORE_ADDR line = MASK (dcache, addr);
+  CORE_ADDR line_size = dcache->line_size;
+  int direction = 0;
+
+  dcache->misses++;
+
+  if (dcache->have_last_fill)
+    {
+      if (line == dcache->last_fill_hi + line_size)
+	direction = 1;
+      else if (line + line_size == dcache->last_fill_lo)
+	direction = -1;
+    }
+
+  if (direction != 0 && direction == dcache->direction)
+    dcache->readahead = std::min (std::max (dcache->readahead * 2, 1u),
+				  dcache_prefetch);
+  else if (direction != 0)
+    dcache->readahead = std::min (1u, dcache_prefetch);
+  else
+    dcache->readahead = 0;
+  dcache->direction = direction;
+
+  CORE_ADDR lo = line;
+  CORE_ADDR hi = line;
+  if (dcache->readahead > 0)
+    {
+      /* Don't read ahead past the memory region of ADDR, or around the
+	 address space.  */
+      struct mem_region *region = lookup_mem_region (line);
+      CORE_ADDR span = dcache->readahead * line_size;
+
+      if (direction > 0)
+	{
+	  hi = line + span;
+	  if (hi < line || hi + line_size < hi
+	      || (region->hi != 0 && hi + line_size > region->hi))
+	    hi = line;
+	}
+      else
+	{
+	  lo = line - span;
+	  if (lo > line || lo < region->lo)
+	    lo = line;
+	}
+    }
+
+  dcache->have_last_fill = true;
+  dcache->last_fill_lo = lo;
+  dcache->last_fill_hi = hi;
+
+  if (lo != hi)
+    {
+      dcache_read_lines (dcache, lo, hi - lo + line_size, line, line_size);
+
+      splay_tree_node node = splay_tree_lookup (dcache->tree,
+						(splay_tree_key) line);
+      if (node != nullptr)
+	return (struct dcache_block *) node->value;
+    }
+
+  struct dcache_block *db = dcache_alloc (dcache, addr);
+
+  dcache->fills++;
+  if (!dcache_read_line (dcache, db))
+    return NULL;
+
+  return db;
+}
+
 /* Using the data cache DCACHE, store in *PTR the contents of the byte at
    address ADDR in the remote machine.  
 
@@ -401,11 +605,20 @@ dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
 {
   struct dcache_block *db = dcache_hit (dcache, addr);
 
-  if (!db)
+  if (db)
+    {
+      dcache->hits++;
+      if (db->prefetched)
+	{
+	  db->prefetched = false;
+	  dcache->prefetch_used++;
+	}
+    }
+  else
     {
-      db = dcache_alloc (dcache, addr);
+      db = dcache_miss (dcache, addr);
 
-      if (!dcache_read_line (dcache, db))
+      if (!db)
 	 return 0;
     }
 
@@ -459,6 +672,15 @@ dcache_init (void)
   dcache->line_size = dcache_line_size;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->have_last_fill = false;
+  dcache->readahead = 0;
+  dcache->direction = 0;
+  dcache->hits = 0;
+  dcache->misses = 0;
+  dcache->fills = 0;
+  dcache->prefetched = 0;
+  dcache->prefetch_used = 0;
+  dcache->prefetch_wasted = 0;
 
   return dcache;
 }
@@ -487,6 +709,11 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
       dcache->proc_target = proc_target;
     }
 
+  /* If the read spans several lines, fetch the missing ones all at
+     once, rather than one at a time as the loop below reaches them.  */
+  if (XFORM (dcache, memaddr) + len > dcache->line_size)
+    dcache_read_lines (dcache, memaddr, len, memaddr, len);
+
   for (i = 0; i < len; i++)
     {
       if (!dcache_peek_byte (dcache, memaddr + i, myaddr + i))
@@ -644,6 +871,13 @@ dcache_info_1 (DCACHE *dcache, const char *exp)
     }
 
   gdb_printf (_("Cache state: %d active lines, %d hits\n"), i, refcount);
+  gdb_printf (_("Accesses: %s hits, %s misses, %s fills\n"),
+	      pulongest (dcache->hits), pulongest (dcache->misses),
+	      pulongest (dcache->fills));
+  gdb_printf (_("Prefetched lines: %s, %s used, %s wasted\n"),
+	      pulongest (dcache->prefetched),
+	      pulongest (dcache->prefetch_used),
+	      pulongest (dcache->prefetch_wasted));
 }
 
 static void
@@ -717,6 +951,17 @@ Show dcache line size."),
 			     set_dcache_line_size,
 			     NULL,
 			     &dcache_set_list, &dcache_show_list);
+  add_setshow_zuinteger_cmd ("prefetch", class_obscure,
+			     &dcache_prefetch, _("\
+Set the maximum number of dcache lines to read ahead."), _("\
+Show the maximum number of dcache lines to read ahead."), _("\
+When a dcache miss is for the line following (or preceding) the lines\n\
+read by the previous miss, the next lines are read along with it, in a\n\
+single target request.  The number of lines read ahead doubles with\n\
+each such miss, up to this limit.  Zero disables read-ahead."),
+			     NULL,
+			     NULL,
+			     &dcache_set_list, &dcache_show_list);
   add_setshow_zuinteger_cmd ("size", class_obscure,
 			     &dcache_size, _("\
 Set number of dcache lines."), _("\
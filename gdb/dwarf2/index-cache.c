@@ -30,9 +30,18 @@
 #include "dwarf2/read.h"
 #include "dwarf2/dwz.h"
 #include "objfiles.h"
+#include "observable.h"
+#include "gdbsupport/filestuff.h"
+#include "run-on-main-thread.h"
 #include "gdbsupport/selftest.h"
+#include <algorithm>
 #include <string>
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#ifdef HAVE_UTIME_H
+#include <utime.h>
+#endif
 
 /* When set to true, show debug messages about the index cache.  */
 static bool debug_index_cache = false;
@@ -51,6 +60,9 @@ index_cache global_index_cache;
 static cmd_list_element *set_index_cache_prefix_list;
 static cmd_list_element *show_index_cache_prefix_list;
 
+/* maintenance index-cache commands.  */
+static cmd_list_element *maintenance_index_cache_list;
+
 /* Default destructor of index_cache_resource.  */
 index_cache_resource::~index_cache_resource () = default;
 
@@ -86,6 +98,17 @@ index_cache::disable ()
   m_enabled = false;
 }
 
+/* Return the number of bytes CONTENTS take on disk.  */
+
+static ULONGEST
+contents_size (const gdb_index_contents &contents)
+{
+  ULONGEST size = contents.objfile_index.size ();
+  if (contents.dwz_index.has_value ())
+    size += contents.dwz_index->size ();
+  return size;
+}
+
 /* See dwarf-index-cache.h.  */
 
 void
@@ -146,11 +169,99 @@ index_cache::store (dwarf2_per_objfile *per_objfile)
       index_cache_debug ("writing index cache for objfile %s",
 			 objfile_name (obj));
 
+      /* Gathering the data for the index needs the psymtabs, so it has
+	 to be done here.  */
+      std::shared_ptr<gdb_index_data> data
+	= snapshot_gdb_index_data (per_objfile);
+      if (data == nullptr)
+	return;
+
+#if CXX_STD_THREAD
+      /* Building the index from DATA and writing it to disk doesn't
+	 need the objfile, so if GDB may use worker threads, let one do
+	 it, and don't make the user wait.  The files are renamed into
+	 place when complete, so a concurrent lookup never sees a
+	 partial file.  */
+      if (gdb::thread_pool::g_thread_pool->thread_count () > 0)
+	{
+	  if (m_store_pool == nullptr)
+	    {
+	      m_store_pool = new gdb::thread_pool ();
+	      m_store_pool->set_thread_count (1);
+	    }
+
+	  /* Forget about the stores that have completed.  */
+	  auto is_done = [] (const std::future<void> &f)
+	    {
+	      return (f.wait_for (std::chrono::seconds (0))
+		      == std::future_status::ready);
+	    };
+	  m_pending_stores.erase (std::remove_if (m_pending_stores.begin (),
+						  m_pending_stores.end (),
+						  is_done),
+				  m_pending_stores.end ());
+
+	  std::string dir = m_dir;
+	  std::string name = objfile_name (obj);
+	  int max_size = m_max_size;
+	  int max_age = m_max_age;
+	  auto task = [=] ()
+	    {
+	      try
+		{
+		  gdb_index_contents contents
+		    = build_gdb_index_contents (*data);
+		  ULONGEST new_size = contents_size (contents);
+		  m_n_bytes_stored += new_size;
+
+		  /* Make room for the new file.  */
+		  if (max_size != -1 || max_age != -1)
+		    {
+		      std::vector<std::string> messages;
+		      prune_directory (dir, max_size, max_age, new_size,
+				       messages);
+		      if (!messages.empty ())
+			run_on_main_thread ([=] ()
+			  {
+			    for (const std::string &message : messages)
+			      index_cache_debug ("%s", message.c_str ());
+			  });
+		    }
+
+		  write_gdb_index_contents
+		    (contents, dir.c_str (), build_id_str.c_str (),
+		     (dwz_build_id_str.has_value ()
+		      ? dwz_build_id_str->c_str () : nullptr));
+		}
+	      catch (const gdb_exception_error &except)
+		{
+		  std::string message = except.what ();
+		  run_on_main_thread ([=] ()
+		    {
+		      index_cache_debug ("couldn't store index cache for "
+					 "objfile %s: %s",
+					 name.c_str (), message.c_str ());
+		    });
+		}
+	    };
+
+	  m_pending_stores.push_back (m_store_pool->post_task (task));
+	  return;
+	}
+#endif /* CXX_STD_THREAD */
+
+      gdb_index_contents contents = build_gdb_index_contents (*data);
+      ULONGEST new_size = contents_size (contents);
+      m_n_bytes_stored += new_size;
+
+      /* Make room for the new file.  */
+      if (m_max_size != -1 || m_max_age != -1)
+	prune (new_size);
+
       /* Write the index itself to the directory, using the build id as the
 	 filename.  */
-      write_psymtabs_to_index (per_objfile, m_dir.c_str (),
-			       build_id_str.c_str (), dwz_build_id_ptr,
-			       dw_index_kind::GDB_INDEX);
+      write_gdb_index_contents (contents, m_dir.c_str (),
+				build_id_str.c_str (), dwz_build_id_ptr);
     }
   catch (const gdb_exception_error &except)
     {
@@ -159,6 +270,124 @@ index_cache::store (dwarf2_per_objfile *per_objfile)
     }
 }
 
+/* See dwarf-index-cache.h.  */
+
+void
+index_cache::wait_for_pending_stores ()
+{
+#if CXX_STD_THREAD
+  if (!m_pending_stores.empty ())
+    index_cache_debug ("waiting for %d pending stores",
+		       (int) m_pending_stores.size ());
+
+  for (std::future<void> &f : m_pending_stores)
+    f.wait ();
+  m_pending_stores.clear ();
+#endif /* CXX_STD_THREAD */
+}
+
+/* See dwarf-index-cache.h.  */
+
+void
+index_cache::prune (ULONGEST new_size)
+{
+  if (m_dir.empty ())
+    return;
+
+  std::vector<std::string> messages;
+  prune_directory (m_dir, m_max_size, m_max_age, new_size, messages);
+  for (const std::string &message : messages)
+    index_cache_debug ("%s", message.c_str ());
+}
+
+/* See dwarf-index-cache.h.  */
+
+void
+index_cache::prune_directory (const std::string &dir_name, int max_size,
+			      int max_age, ULONGEST new_size,
+			      std::vector<std::string> &messages)
+{
+  gdb_dir_up dir (opendir (dir_name.c_str ()));
+  if (dir == nullptr)
+    {
+      messages.push_back (string_printf ("couldn't open %s: %s",
+					 dir_name.c_str (),
+					 safe_strerror (errno)));
+      return;
+    }
+
+  /* An index file found in the cache directory.  */
+  struct cache_file
+  {
+    std::string filename;
+    ULONGEST size;
+    time_t mtime;
+  };
+
+  std::vector<cache_file> files;
+  ULONGEST total_size = 0;
+  const size_t suffix_len = strlen (INDEX4_SUFFIX);
+
+  for (struct dirent *ent = readdir (dir.get ());
+       ent != nullptr;
+       ent = readdir (dir.get ()))
+    {
+      size_t len = strlen (ent->d_name);
+      if (len <= suffix_len
+	  || strcmp (ent->d_name + len - suffix_len, INDEX4_SUFFIX) != 0)
+	continue;
+
+      std::string filename = dir_name + SLASH_STRING + ent->d_name;
+      struct stat st;
+      if (stat (filename.c_str (), &st) != 0 || !S_ISREG (st.st_mode))
+	continue;
+
+      files.push_back ({std::move (filename), (ULONGEST) st.st_size,
+			st.st_mtime});
+      total_size += st.st_size;
+    }
+
+  /* The modification time of a file is updated when it is used (see
+     lookup_gdb_index), so this puts the least recently used files
+     first.  */
+  std::sort (files.begin (), files.end (),
+	     [] (const cache_file &a, const cache_file &b)
+	     {
+	       return a.mtime < b.mtime;
+	     });
+
+  const time_t now = time (nullptr);
+  for (const cache_file &file : files)
+    {
+      bool too_old = (max_age != -1
+		      && now - file.mtime > (time_t) max_age * 24 * 60 * 60);
+      /* Leave room for the file that is about to be stored.  */
+      bool too_big = (max_size != -1
+		      && (total_size + new_size
+			  > (ULONGEST) max_size * 1024 * 1024));
+
+      /* The remaining files are all more recent.  */
+      if (!too_old && !too_big)
+	break;
+
+      if (unlink (file.filename.c_str ()) != 0)
+	{
+	  messages.push_back (string_printf ("couldn't remove %s: %s",
+					     file.filename.c_str (),
+					     safe_strerror (errno)));
+	  continue;
+	}
+
+      messages.push_back (string_printf ("evicted %s (%s bytes)",
+					 file.filename.c_str (),
+					 pulongest (file.size)));
+
+      total_size -= file.size;
+      m_n_evictions++;
+      m_n_bytes_evicted += file.size;
+    }
+}
+
 #if HAVE_SYS_MMAN_H
 
 /* Hold the resources for an mmapped index file.  */
@@ -205,6 +434,18 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
       /* Yay, it worked!  Hand the resource to the caller.  */
       resource->reset (mmap_resource);
 
+      m_n_bytes_read += mmap_resource->mapping.size ();
+
+      /* Record that the file was used, prune evicts the least recently
+	 used files first.  The access time can't be relied on for
+	 this, as many file systems are mounted with noatime or
+	 relatime.  */
+#ifdef HAVE_UTIME_H
+      if (utime (filename.c_str (), nullptr) != 0)
+	index_cache_debug ("couldn't update the modification time of %s: %s",
+			   filename.c_str (), safe_strerror (errno));
+#endif
+
       return gdb::array_view<const gdb_byte>
 	  ((const gdb_byte *) mmap_resource->mapping.get (),
 	   mmap_resource->mapping.size ());
@@ -304,6 +545,86 @@ set_index_cache_directory_command (const char *arg, int from_tty,
   global_index_cache.set_directory (index_cache_directory);
 }
 
+/* "set/show index-cache max-size" set callback.  */
+
+static void
+set_index_cache_max_size_command (int value)
+{
+  global_index_cache.set_max_size (value);
+}
+
+/* "set/show index-cache max-size" get callback.  */
+
+static int
+get_index_cache_max_size_command ()
+{
+  return global_index_cache.max_size ();
+}
+
+/* "set/show index-cache max-size" show callback.  */
+
+static void
+show_index_cache_max_size_command (ui_file *stream, int from_tty,
+				   cmd_list_element *cmd, const char *value)
+{
+  if (global_index_cache.max_size () == -1)
+    gdb_printf (stream, _("The size of the index cache is unlimited.\n"));
+  else
+    gdb_printf (stream,
+		_("The maximum size of the index cache is %s megabytes.\n"),
+		value);
+}
+
+/* "set/show index-cache max-age" set callback.  */
+
+static void
+set_index_cache_max_age_command (int value)
+{
+  global_index_cache.set_max_age (value);
+}
+
+/* "set/show index-cache max-age" get callback.  */
+
+static int
+get_index_cache_max_age_command ()
+{
+  return global_index_cache.max_age ();
+}
+
+/* "set/show index-cache max-age" show callback.  */
+
+static void
+show_index_cache_max_age_command (ui_file *stream, int from_tty,
+				  cmd_list_element *cmd, const char *value)
+{
+  if (global_index_cache.max_age () == -1)
+    gdb_printf (stream,
+		_("The age of the files in the index cache is unlimited.\n"));
+  else
+    gdb_printf (stream,
+		_("The maximum age of the files in the index cache "
+		  "is %s days.\n"),
+		value);
+}
+
+/* "maintenance index-cache prune" handler.  */
+
+static void
+maintenance_index_cache_prune (const char *args, int from_tty)
+{
+  /* Make sure the files being written are taken into account.  */
+  global_index_cache.wait_for_pending_stores ();
+  global_index_cache.prune ();
+}
+
+/* "maintenance wait-for-index-cache" handler.  */
+
+static void
+maintenance_wait_for_index_cache (const char *args, int from_tty)
+{
+  global_index_cache.wait_for_pending_stores ();
+}
+
 /* "show index-cache stats" handler.  */
 
 static void
@@ -311,6 +632,10 @@ show_index_cache_stats_command (const char *arg, int from_tty)
 {
   const char *indent = "";
 
+  /* The size of the index files being stored is only known once they
+     are built.  */
+  global_index_cache.wait_for_pending_stores ();
+
   /* If this command is invoked through "show index-cache", make the display a
      bit nicer.  */
   if (in_show_index_cache_command)
@@ -323,12 +648,28 @@ show_index_cache_stats_command (const char *arg, int from_tty)
 	      indent, global_index_cache.n_hits ());
   gdb_printf (_("%sCache misses (this session): %u\n"),
 	      indent, global_index_cache.n_misses ());
+  gdb_printf (_("%s  Bytes read (this session): %s\n"),
+	      indent, pulongest (global_index_cache.n_bytes_read ()));
+  gdb_printf (_("%sBytes stored (this session): %s\n"),
+	      indent, pulongest (global_index_cache.n_bytes_stored ()));
+  gdb_printf (_("%s   Evictions (this session): %u (%s bytes)\n"),
+	      indent, global_index_cache.n_evictions (),
+	      pulongest (global_index_cache.n_bytes_evicted ()));
 }
 
 void _initialize_index_cache ();
 void
 _initialize_index_cache ()
 {
+  /* Make sure the index files being written in the background are
+     complete before GDB exits.  */
+  gdb::observers::gdb_exiting.attach
+    ([] (int exit_code)
+     {
+       global_index_cache.wait_for_pending_stores ();
+     },
+     "index-cache");
+
   /* Set the default index cache directory.  */
   std::string cache_dir = get_standard_cache_dir ();
   if (!cache_dir.empty ())
@@ -385,11 +726,53 @@ _initialize_index_cache ()
 			    &set_index_cache_prefix_list,
 			    &show_index_cache_prefix_list);
 
+  /* set/show index-cache max-size */
+  add_setshow_zuinteger_unlimited_cmd ("max-size", class_files, _("\
+Set the maximum size of the index cache, in megabytes."), _("\
+Show the maximum size of the index cache, in megabytes."), _("\
+When the index cache grows larger than this, the least recently used\n\
+index files are removed from it.  \"unlimited\" means no limit."),
+				       set_index_cache_max_size_command,
+				       get_index_cache_max_size_command,
+				       show_index_cache_max_size_command,
+				       &set_index_cache_prefix_list,
+				       &show_index_cache_prefix_list);
+
+  /* set/show index-cache max-age */
+  add_setshow_zuinteger_unlimited_cmd ("max-age", class_files, _("\
+Set the maximum age of the files in the index cache, in days."), _("\
+Show the maximum age of the files in the index cache, in days."), _("\
+Index files that have not been used for longer than this are removed\n\
+from the cache.  \"unlimited\" means no limit."),
+				       set_index_cache_max_age_command,
+				       get_index_cache_max_age_command,
+				       show_index_cache_max_age_command,
+				       &set_index_cache_prefix_list,
+				       &show_index_cache_prefix_list);
+
   /* show index-cache stats */
   add_cmd ("stats", class_files, show_index_cache_stats_command,
 	   _("Show some stats about the index cache."),
 	   &show_index_cache_prefix_list);
 
+  /* maintenance index-cache */
+  add_basic_prefix_cmd ("index-cache", class_maintenance,
+			_("Commands for maintaining the index cache."),
+			&maintenance_index_cache_list, 0, &maintenancelist);
+
+  /* maintenance index-cache prune */
+  add_cmd ("prune", class_maintenance, maintenance_index_cache_prune, _("\
+Remove the index files that exceed the index cache limits.\n\
+Usage: maintenance index-cache prune\n\
+See \"set index-cache max-size\" and \"set index-cache max-age\"."),
+	   &maintenance_index_cache_list);
+
+  add_cmd ("wait-for-index-cache", class_maintenance,
+	   maintenance_wait_for_index_cache, _("\
+Wait until all pending writes to the index cache have completed.\n\
+Usage: maintenance wait-for-index-cache"),
+	   &maintenancelist);
+
   /* set debug index-cache */
   add_setshow_boolean_cmd ("index-cache", class_maintenance,
 			   &debug_index_cache,
@@ -23,6 +23,11 @@
 #include "dwarf2/index-common.h"
 #include "gdbsupport/array-view.h"
 #include "symfile.h"
+#include <atomic>
+#if CXX_STD_THREAD
+#include <future>
+#include "gdbsupport/thread-pool.h"
+#endif
 
 /* Base of the classes used to hold the resources of the indices loaded from
    the cache (e.g. mmapped files).  */
@@ -52,9 +57,16 @@ class index_cache
   /* Disable the cache.  */
   void disable ();
 
-  /* Store an index for the specified object file in the cache.  */
+  /* Store an index for the specified object file in the cache.  The
+     data needed from the objfile is gathered right away, but the index
+     may be built and written to disk by a worker thread after this
+     returns.  */
   void store (dwarf2_per_objfile *per_objfile);
 
+  /* Wait until all the index files that are being written by worker
+     threads are in the cache.  */
+  void wait_for_pending_stores ();
+
   /* Look for an index file matching BUILD_ID.  If found, return the contents
      as an array_view and store the underlying resources (allocated memory,
      mapped file, etc) in RESOURCE.  The returned array_view is valid as long
@@ -87,8 +99,59 @@ class index_cache
       m_n_misses++;
   }
 
+  /* Return the number of bytes of index files read from the cache.  */
+  ULONGEST n_bytes_read () const
+  { return m_n_bytes_read; }
+
+  /* Return the number of bytes of index files stored in the cache.  */
+  ULONGEST n_bytes_stored () const
+  { return m_n_bytes_stored; }
+
+  /* Return the number of index files evicted from the cache.  */
+  unsigned int n_evictions () const
+  { return m_n_evictions; }
+
+  /* Return the number of bytes of index files evicted from the
+     cache.  */
+  ULONGEST n_bytes_evicted () const
+  { return m_n_bytes_evicted; }
+
+  /* Return the maximum size of the cache, in megabytes, or -1 if it is
+     unlimited.  */
+  int max_size () const
+  { return m_max_size; }
+
+  /* Set the maximum size of the cache, in megabytes, or -1 for no
+     limit.  */
+  void set_max_size (int max_size)
+  { m_max_size = max_size; }
+
+  /* Return the maximum age of the files in the cache, in days, or -1
+     if it is unlimited.  */
+  int max_age () const
+  { return m_max_age; }
+
+  /* Set the maximum age of the files in the cache, in days, or -1 for
+     no limit.  */
+  void set_max_age (int max_age)
+  { m_max_age = max_age; }
+
+  /* Remove the index files that have not been used for longer than the
+     maximum age from the cache directory, then the least recently used
+     ones until the cache is no larger than the maximum size, minus
+     NEW_SIZE bytes kept for a file about to be stored.  */
+  void prune (ULONGEST new_size = 0);
+
 private:
 
+  /* Like prune, but for the cache directory DIR_NAME and the limits
+     MAX_SIZE and MAX_AGE.  The debug messages are appended to MESSAGES
+     instead of being printed.  This uses no other state than the
+     statistics, so it may be called from a worker thread.  */
+  void prune_directory (const std::string &dir_name, int max_size,
+			int max_age, ULONGEST new_size,
+			std::vector<std::string> &messages);
+
   /* Compute the absolute filename where the index of the objfile with build
      id BUILD_ID will be stored.  SUFFIX is appended at the end of the
      filename.  */
@@ -104,6 +167,31 @@ class index_cache
   /* Number of cache hits and misses during this GDB session.  */
   unsigned int m_n_hits = 0;
   unsigned int m_n_misses = 0;
+
+  /* Number of bytes read from and stored in the cache, and number of
+     files and bytes evicted from it, during this GDB session.  */
+  ULONGEST m_n_bytes_read = 0;
+  std::atomic<ULONGEST> m_n_bytes_stored { 0 };
+  std::atomic<unsigned int> m_n_evictions { 0 };
+  std::atomic<ULONGEST> m_n_bytes_evicted { 0 };
+
+  /* The limits used by prune, -1 meaning no limit.  The size is in
+     megabytes, the age in days.  */
+  int m_max_size = -1;
+  int m_max_age = -1;
+
+#if CXX_STD_THREAD
+  /* The thread pool, with a single worker thread, that the stores are
+     handed to.  It is separate from the global thread pool, so that a
+     slow store doesn't hold up the work posted there, like the
+     reading of the next objfile's DWARF.  Created on first use, and
+     never destroyed.  */
+  gdb::thread_pool *m_store_pool = nullptr;
+
+  /* The stores that were handed to the worker thread, and that may not
+     have completed yet.  */
+  std::vector<std::future<void>> m_pending_stores;
+#endif
 };
 
 /* The global instance of the index cache.  */
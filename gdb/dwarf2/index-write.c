@@ -26,6 +26,7 @@
 #include "gdbsupport/byte-vector.h"
 #include "gdbsupport/filestuff.h"
 #include "gdbsupport/gdb_unlinker.h"
+#include "gdbsupport/parallel-for.h"
 #include "gdbsupport/pathstuff.h"
 #include "gdbsupport/scoped_fd.h"
 #include "complaints.h"
@@ -154,6 +155,20 @@ class data_buf
     ::file_write (file, m_vec);
   }
 
+  /* Copy the contents of BUF to the end of the buffer.  */
+  void append_data (const data_buf &buf)
+  {
+    append_array (buf.m_vec);
+  }
+
+  /* Return the contents of the buffer, leaving it empty.  */
+  gdb::byte_vector release ()
+  {
+    gdb::byte_vector result = std::move (m_vec);
+    m_vec.clear ();
+    return result;
+  }
+
 private:
   /* Grow SIZE bytes at the end of the buffer.  Returns a pointer to
      the start of the new block.  */
@@ -171,6 +186,8 @@ struct symtab_index_entry
 {
   /* The name of the symbol.  */
   const char *name;
+  /* The hash of NAME, as computed by mapped_index_string_hash.  */
+  offset_type hash;
   /* The offset of the name in the constant pool.  */
   offset_type index_offset;
   /* A sorted vector of the indices of all the CUs that hold an object
@@ -189,6 +206,19 @@ struct mapped_symtab
   offset_type n_elements = 0;
   std::vector<symtab_index_entry> data;
 
+  /* A symbol recorded by add_index_entry, but not inserted into DATA
+     yet.  */
+  struct pending_entry
+  {
+    const char *name;
+    offset_type hash;
+    offset_type cu_index_and_attrs;
+  };
+
+  /* The symbols to be inserted by insert_pending_entries, in the order
+     they were added.  */
+  std::vector<pending_entry> pending;
+
   /* Temporary storage for Ada names.  */
   auto_obstack m_string_obstack;
 };
@@ -200,9 +230,9 @@ struct mapped_symtab
    compatibility is needed.  */
 
 static symtab_index_entry &
-find_slot (struct mapped_symtab *symtab, const char *name)
+find_slot (struct mapped_symtab *symtab, const char *name, offset_type hash)
 {
-  offset_type index, step, hash = mapped_index_string_hash (INT_MAX, name);
+  offset_type index, step;
 
   index = hash & (symtab->data.size () - 1);
   step = ((hash * 17) & (symtab->data.size () - 1)) | 1;
@@ -210,7 +240,8 @@ find_slot (struct mapped_symtab *symtab, const char *name)
   for (;;)
     {
       if (symtab->data[index].name == NULL
-	  || strcmp (name, symtab->data[index].name) == 0)
+	  || (symtab->data[index].hash == hash
+	      && strcmp (name, symtab->data[index].name) == 0))
 	return symtab->data[index];
       index = (index + step) & (symtab->data.size () - 1);
     }
@@ -229,14 +260,17 @@ hash_expand (struct mapped_symtab *symtab)
   for (auto &it : old_entries)
     if (it.name != NULL)
       {
-	auto &ref = find_slot (symtab, it.name);
+	auto &ref = find_slot (symtab, it.name, it.hash);
 	ref = std::move (it);
       }
 }
 
 /* Add an entry to SYMTAB.  NAME is the name of the symbol.
    CU_INDEX is the index of the CU in which the symbol appears.
-   IS_STATIC is one if the symbol is static, otherwise zero (global).  */
+   IS_STATIC is one if the symbol is static, otherwise zero (global).
+
+   The entry is only recorded here, insert_pending_entries does the
+   actual insertion into the hash table.  */
 
 static void
 add_index_entry (struct mapped_symtab *symtab, const char *name,
@@ -245,47 +279,113 @@ add_index_entry (struct mapped_symtab *symtab, const char *name,
 {
   offset_type cu_index_and_attrs;
 
-  ++symtab->n_elements;
-  if (4 * symtab->n_elements / 3 >= symtab->data.size ())
-    hash_expand (symtab);
-
-  symtab_index_entry &slot = find_slot (symtab, name);
-  if (slot.name == NULL)
-    {
-      slot.name = name;
-      /* index_offset is set later.  */
-    }
-
   cu_index_and_attrs = 0;
   DW2_GDB_INDEX_CU_SET_VALUE (cu_index_and_attrs, cu_index);
   DW2_GDB_INDEX_SYMBOL_STATIC_SET_VALUE (cu_index_and_attrs, is_static);
   DW2_GDB_INDEX_SYMBOL_KIND_SET_VALUE (cu_index_and_attrs, kind);
 
-  /* We don't want to record an index value twice as we want to avoid the
-     duplication.
-     We process all global symbols and then all static symbols
-     (which would allow us to avoid the duplication by only having to check
-     the last entry pushed), but a symbol could have multiple kinds in one CU.
-     To keep things simple we don't worry about the duplication here and
-     sort and uniquify the list after we've processed all symbols.  */
-  slot.cu_indices.push_back (cu_index_and_attrs);
+  /* The hash is computed later, by insert_pending_entries.  */
+  symtab->pending.push_back ({name, 0, cu_index_and_attrs});
 }
 
-/* Sort and remove duplicates of all symbols' cu_indices lists.  */
+/* Insert the entries recorded by add_index_entry into SYMTAB's hash
+   table.  If USE_THREADS, hashing the names is done on the worker
+   threads.  The insertion itself is done serially, in the order the
+   entries were added, so that the resulting table does not depend on
+   the number of threads.  */
 
 static void
-uniquify_cu_indices (struct mapped_symtab *symtab)
+insert_pending_entries (struct mapped_symtab *symtab, bool use_threads)
 {
-  for (auto &entry : symtab->data)
+  using pending_entry = mapped_symtab::pending_entry;
+  std::vector<pending_entry> &pending = symtab->pending;
+
+  using pending_iter = std::vector<pending_entry>::iterator;
+  auto hash_names = [] (pending_iter first, pending_iter last)
+    {
+      for (; first != last; ++first)
+	first->hash = mapped_index_string_hash (INT_MAX, first->name);
+    };
+
+  if (use_threads)
     {
-      if (entry.name != NULL && !entry.cu_indices.empty ())
+      auto estimate_size = [] (pending_iter iter) -> size_t
+	{
+	  return strlen (iter->name) + 1;
+	};
+      gdb::function_view<size_t (pending_iter)> task_size = estimate_size;
+
+      gdb::parallel_for_each (pending.begin (), pending.end (), hash_names,
+			      task_size);
+    }
+  else
+    hash_names (pending.begin (), pending.end ());
+
+  for (const pending_entry &entry : pending)
+    {
+      ++symtab->n_elements;
+      if (4 * symtab->n_elements / 3 >= symtab->data.size ())
+	hash_expand (symtab);
+
+      symtab_index_entry &slot = find_slot (symtab, entry.name, entry.hash);
+      if (slot.name == NULL)
 	{
-	  auto &cu_indices = entry.cu_indices;
+	  slot.name = entry.name;
+	  slot.hash = entry.hash;
+	  /* index_offset is set later.  */
+	}
+
+      /* We don't want to record an index value twice as we want to
+	 avoid the duplication.
+	 We process all global symbols and then all static symbols
+	 (which would allow us to avoid the duplication by only having to
+	 check the last entry pushed), but a symbol could have multiple
+	 kinds in one CU.  To keep things simple we don't worry about the
+	 duplication here and sort and uniquify the list after we've
+	 processed all symbols.  */
+      slot.cu_indices.push_back (entry.cu_index_and_attrs);
+    }
+
+  pending.clear ();
+  pending.shrink_to_fit ();
+}
+
+/* Sort and remove duplicates of all symbols' cu_indices lists.  If
+   USE_THREADS, the work is spread over the worker threads.  */
+
+static void
+uniquify_cu_indices (struct mapped_symtab *symtab, bool use_threads)
+{
+  using entry_iter = std::vector<symtab_index_entry>::iterator;
+  auto uniquify = [] (entry_iter first, entry_iter last)
+    {
+      for (; first != last; ++first)
+	{
+	  auto &cu_indices = first->cu_indices;
+	  if (first->name == NULL || cu_indices.size () < 2)
+	    continue;
 	  std::sort (cu_indices.begin (), cu_indices.end ());
 	  auto from = std::unique (cu_indices.begin (), cu_indices.end ());
 	  cu_indices.erase (from, cu_indices.end ());
 	}
+    };
+
+  if (use_threads)
+    {
+      /* Most of the slots are empty or hold a single CU index, so
+	 split the work by the number of indices rather than by
+	 slot.  */
+      auto estimate_size = [] (entry_iter iter) -> size_t
+	{
+	  return iter->cu_indices.size () + 1;
+	};
+      gdb::function_view<size_t (entry_iter)> task_size = estimate_size;
+
+      gdb::parallel_for_each (symtab->data.begin (), symtab->data.end (),
+			      uniquify, task_size);
     }
+  else
+    uniquify (symtab->data.begin (), symtab->data.end ());
 }
 
 /* A form of 'const char *' suitable for container keys.  Only the
@@ -1253,12 +1353,11 @@ assert_file_size (FILE *file, size_t expected_size)
   gdb_assert (file_size == expected_size);
 }
 
-/* Write a gdb index file to OUT_FILE from all the sections passed as
-   arguments.  */
+/* Return the contents of a gdb index file made of all the sections
+   passed as arguments.  */
 
-static void
-write_gdbindex_1 (FILE *out_file,
-		  const data_buf &cu_list,
+static gdb::byte_vector
+write_gdbindex_1 (const data_buf &cu_list,
 		  const data_buf &types_cu_list,
 		  const data_buf &addr_vec,
 		  const data_buf &symtab_vec,
@@ -1293,29 +1392,46 @@ write_gdbindex_1 (FILE *out_file,
 
   gdb_assert (contents.size () == size_of_header);
 
-  contents.file_write (out_file);
-  cu_list.file_write (out_file);
-  types_cu_list.file_write (out_file);
-  addr_vec.file_write (out_file);
-  symtab_vec.file_write (out_file);
-  constant_pool.file_write (out_file);
+  contents.append_data (cu_list);
+  contents.append_data (types_cu_list);
+  contents.append_data (addr_vec);
+  contents.append_data (symtab_vec);
+  contents.append_data (constant_pool);
 
-  assert_file_size (out_file, total_len);
+  gdb_assert (contents.size () == total_len);
+
+  return contents.release ();
 }
 
-/* Write contents of a .gdb_index section for OBJFILE into OUT_FILE.
-   If OBJFILE has an associated dwz file, write contents of a .gdb_index
-   section for that dwz file into DWZ_OUT_FILE.  If OBJFILE does not have an
-   associated dwz file, DWZ_OUT_FILE must be NULL.  */
+/* The data gathered from the psymtabs of an objfile that is needed to
+   build its .gdb_index, see collect_gdbindex_data.  */
 
-static void
-write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
-		FILE *dwz_out_file)
+struct gdb_index_data
 {
-  struct objfile *objfile = per_objfile->objfile;
+  /* The symbols, not inserted in the hash table yet.  */
   mapped_symtab symtab;
+
+  /* The CU lists of the objfile and of its dwz file, and the list of
+     type units.  */
   data_buf objfile_cu_list;
   data_buf dwz_cu_list;
+  data_buf types_cu_list;
+
+  /* The address table.  */
+  data_buf addr_vec;
+
+  /* Whether the objfile has a dwz file.  */
+  bool have_dwz = false;
+};
+
+/* Walk the psymtabs of PER_OBJFILE and fill DATA with what is needed to
+   build its .gdb_index.  This is the only part of building the index
+   that looks at the objfile.  */
+
+static void
+collect_gdbindex_data (dwarf2_per_objfile *per_objfile, gdb_index_data &data)
+{
+  struct objfile *objfile = per_objfile->objfile;
 
   /* While we're scanning CU's create a table that maps a psymtab pointer
      (which is what addrmap records) to its index (which is what is recorded
@@ -1324,9 +1440,6 @@ write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
   psym_index_map cu_index_htab;
   cu_index_htab.reserve (per_objfile->per_bfd->all_comp_units.size ());
 
-  /* Store out the .debug_type CUs, if any.  */
-  data_buf types_cu_list;
-
   /* The CU list is already sorted, so we don't need to do additional
      work here.  Also, the debug_types entries do not appear in
      all_comp_units, but only in their own hash table.  */
@@ -1346,7 +1459,7 @@ write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
       if (psymtab != NULL)
 	{
 	  if (psymtab->user == NULL)
-	    recursively_write_psymbols (objfile, psymtab, &symtab,
+	    recursively_write_psymbols (objfile, psymtab, &data.symtab,
 					psyms_seen, this_counter);
 
 	  const auto insertpair = cu_index_htab.emplace (psymtab,
@@ -1358,8 +1471,9 @@ write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
 	 from the eventual dwz file.  We need to place the entry in the
 	 corresponding index.  */
       data_buf &cu_list = (per_cu->is_debug_types
-			   ? types_cu_list
-			   : per_cu->is_dwz ? dwz_cu_list : objfile_cu_list);
+			   ? data.types_cu_list
+			   : per_cu->is_dwz
+			   ? data.dwz_cu_list : data.objfile_cu_list);
       cu_list.append_uint (8, BFD_ENDIAN_LITTLE,
 			   to_underlying (per_cu->sect_off));
       if (per_cu->is_debug_types)
@@ -1377,12 +1491,24 @@ write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
     }
 
   /* Dump the address map.  */
-  data_buf addr_vec;
-  write_address_map (per_objfile->per_bfd, addr_vec, cu_index_htab);
+  write_address_map (per_objfile->per_bfd, data.addr_vec, cu_index_htab);
+
+  data.have_dwz = dwarf2_get_dwz_file (per_objfile->per_bfd) != nullptr;
+}
+
+/* Build the contents of the .gdb_index sections from DATA.  This only
+   uses DATA.  If USE_THREADS, some of the work is spread over the
+   worker threads.  */
 
-  /* Now that we've processed all symbols we can shrink their cu_indices
-     lists.  */
-  uniquify_cu_indices (&symtab);
+static gdb_index_contents
+build_gdbindex (gdb_index_data &data, bool use_threads)
+{
+  mapped_symtab &symtab = data.symtab;
+
+  /* Now that we've processed all symbols we can build the hash table
+     and shrink their cu_indices lists.  */
+  insert_pending_entries (&symtab, use_threads);
+  uniquify_cu_indices (&symtab, use_threads);
 
   data_buf symtab_vec, constant_pool;
   if (symtab.n_elements == 0)
@@ -1390,13 +1516,32 @@ write_gdbindex (dwarf2_per_objfile *per_objfile, FILE *out_file,
 
   write_hash_table (&symtab, symtab_vec, constant_pool);
 
-  write_gdbindex_1(out_file, objfile_cu_list, types_cu_list, addr_vec,
-		   symtab_vec, constant_pool);
+  gdb_index_contents result;
+  result.objfile_index = write_gdbindex_1 (data.objfile_cu_list,
+					   data.types_cu_list,
+					   data.addr_vec, symtab_vec,
+					   constant_pool);
 
-  if (dwz_out_file != NULL)
-    write_gdbindex_1 (dwz_out_file, dwz_cu_list, {}, {}, {}, {});
+  if (data.have_dwz)
+    result.dwz_index.emplace (write_gdbindex_1 (data.dwz_cu_list,
+						{}, {}, {}, {}));
   else
-    gdb_assert (dwz_cu_list.empty ());
+    gdb_assert (data.dwz_cu_list.empty ());
+
+  return result;
+}
+
+/* Compute the contents of a .gdb_index section for OBJFILE, and, if
+   OBJFILE has an associated dwz file, of a .gdb_index section for that
+   dwz file.  */
+
+static gdb_index_contents
+write_gdbindex (dwarf2_per_objfile *per_objfile)
+{
+  gdb_index_data data;
+
+  collect_gdbindex_data (per_objfile, data);
+  return build_gdbindex (data, true);
 }
 
 /* DWARF-5 augmentation string for GDB's DW_IDX_GNU_* extension.  */
@@ -1574,12 +1719,12 @@ struct index_wip_file
   gdb_file_up out_file;
 };
 
-/* See dwarf-index-write.h.  */
+/* Return true if an index can be created for PER_OBJFILE, false if
+   there is nothing to write.  Throw an error if creating one is not
+   possible.  */
 
-void
-write_psymtabs_to_index (dwarf2_per_objfile *per_objfile, const char *dir,
-			 const char *basename, const char *dwz_basename,
-			 dw_index_kind index_kind)
+static bool
+check_can_write_index (dwarf2_per_objfile *per_objfile)
 {
   dwarf2_per_bfd *per_bfd = per_objfile->per_bfd;
   struct objfile *objfile = per_objfile->objfile;
@@ -1593,34 +1738,111 @@ write_psymtabs_to_index (dwarf2_per_objfile *per_objfile, const char *dir,
   if (per_bfd->partial_symtabs == nullptr
       || !per_bfd->partial_symtabs->psymtabs
       || !per_bfd->partial_symtabs->psymtabs_addrmap)
-    return;
+    return false;
 
   struct stat st;
   if (stat (objfile_name (objfile), &st) < 0)
     perror_with_name (objfile_name (objfile));
 
-  const char *index_suffix = (index_kind == dw_index_kind::DEBUG_NAMES
-			      ? INDEX5_SUFFIX : INDEX4_SUFFIX);
+  return true;
+}
+
+/* See dwarf-index-write.h.  */
+
+gdb::optional<gdb_index_contents>
+compute_gdb_index_contents (dwarf2_per_objfile *per_objfile)
+{
+  if (!check_can_write_index (per_objfile))
+    return {};
+
+  return write_gdbindex (per_objfile);
+}
+
+/* See dwarf-index-write.h.  */
+
+std::shared_ptr<gdb_index_data>
+snapshot_gdb_index_data (dwarf2_per_objfile *per_objfile)
+{
+  if (!check_can_write_index (per_objfile))
+    return {};
 
-  index_wip_file objfile_index_wip (dir, basename, index_suffix);
+  std::shared_ptr<gdb_index_data> data = std::make_shared<gdb_index_data> ();
+  collect_gdbindex_data (per_objfile, *data);
+
+  /* The names point into the objfile, which may be gone by the time
+     the index is built, so make copies.  */
+  auto_obstack &names = data->symtab.m_string_obstack;
+  for (mapped_symtab::pending_entry &entry : data->symtab.pending)
+    entry.name = obstack_strdup (&names, entry.name);
+
+  return data;
+}
+
+/* See dwarf-index-write.h.  */
+
+gdb_index_contents
+build_gdb_index_contents (gdb_index_data &data)
+{
+  /* This may run in a worker thread, which must not wait for other
+     tasks of the thread pool.  */
+  return build_gdbindex (data, false);
+}
+
+/* See dwarf-index-write.h.  */
+
+void
+write_gdb_index_contents (const gdb_index_contents &contents,
+			  const char *dir, const char *basename,
+			  const char *dwz_basename)
+{
+  index_wip_file objfile_index_wip (dir, basename, INDEX4_SUFFIX);
   gdb::optional<index_wip_file> dwz_index_wip;
 
-  if (dwz_basename != NULL)
-      dwz_index_wip.emplace (dir, dwz_basename, index_suffix);
+  if (dwz_basename != NULL && contents.dwz_index.has_value ())
+    dwz_index_wip.emplace (dir, dwz_basename, INDEX4_SUFFIX);
 
-  if (index_kind == dw_index_kind::DEBUG_NAMES)
-    {
-      index_wip_file str_wip_file (dir, basename, DEBUG_STR_SUFFIX);
+  file_write (objfile_index_wip.out_file.get (), contents.objfile_index);
+  if (dwz_index_wip.has_value ())
+    file_write (dwz_index_wip->out_file.get (), *contents.dwz_index);
 
-      write_debug_names (per_objfile, objfile_index_wip.out_file.get (),
-			 str_wip_file.out_file.get ());
+  objfile_index_wip.finalize ();
 
-      str_wip_file.finalize ();
+  if (dwz_index_wip.has_value ())
+    dwz_index_wip->finalize ();
+}
+
+/* See dwarf-index-write.h.  */
+
+void
+write_psymtabs_to_index (dwarf2_per_objfile *per_objfile, const char *dir,
+			 const char *basename, const char *dwz_basename,
+			 dw_index_kind index_kind)
+{
+  if (index_kind == dw_index_kind::GDB_INDEX)
+    {
+      gdb::optional<gdb_index_contents> contents
+	= compute_gdb_index_contents (per_objfile);
+
+      if (contents.has_value ())
+	write_gdb_index_contents (*contents, dir, basename, dwz_basename);
+      return;
     }
-  else
-    write_gdbindex (per_objfile, objfile_index_wip.out_file.get (),
-		    (dwz_index_wip.has_value ()
-		     ? dwz_index_wip->out_file.get () : NULL));
+
+  if (!check_can_write_index (per_objfile))
+    return;
+
+  index_wip_file objfile_index_wip (dir, basename, INDEX5_SUFFIX);
+  gdb::optional<index_wip_file> dwz_index_wip;
+
+  if (dwz_basename != NULL)
+      dwz_index_wip.emplace (dir, dwz_basename, INDEX5_SUFFIX);
+
+  index_wip_file str_wip_file (dir, basename, DEBUG_STR_SUFFIX);
+
+  write_debug_names (per_objfile, objfile_index_wip.out_file.get (),
+		     str_wip_file.out_file.get ());
+
+  str_wip_file.finalize ();
 
   objfile_index_wip.finalize ();
 
@@ -22,6 +22,9 @@
 
 #include "dwarf2/read.h"
 #include "dwarf2/public.h"
+#include "gdbsupport/byte-vector.h"
+#include "gdbsupport/gdb_optional.h"
+#include <memory>
 
 /* Create index files for OBJFILE in the directory DIR.
 
@@ -36,4 +39,57 @@ extern void write_psymtabs_to_index
   (dwarf2_per_objfile *per_objfile, const char *dir, const char *basename,
    const char *dwz_basename, dw_index_kind index_kind);
 
+/* The contents of the .gdb_index file of an objfile and, if it has
+   one, of its dwz file.  These do not refer to the objfile, so they
+   can still be written out once it is gone, from any thread.  */
+
+struct gdb_index_contents
+{
+  /* The contents of the objfile's index.  */
+  gdb::byte_vector objfile_index;
+
+  /* The contents of the dwz file's index, if there is a dwz file.  */
+  gdb::optional<gdb::byte_vector> dwz_index;
+};
+
+/* Compute the contents of the .gdb_index files that
+   write_psymtabs_to_index would write for PER_OBJFILE, without
+   writing anything.  Return an empty optional if there is nothing to
+   write.  */
+
+extern gdb::optional<gdb_index_contents> compute_gdb_index_contents
+  (dwarf2_per_objfile *per_objfile);
+
+/* The data needed to build the .gdb_index files of an objfile, see
+   snapshot_gdb_index_data.  */
+
+struct gdb_index_data;
+
+/* Gather from the psymtabs of PER_OBJFILE everything that is needed to
+   build its .gdb_index files, so that the rest of the work can be done
+   by build_gdb_index_contents, possibly in a worker thread and after
+   the objfile is gone.  Return an empty pointer if there is nothing to
+   write.  */
+
+extern std::shared_ptr<gdb_index_data> snapshot_gdb_index_data
+  (dwarf2_per_objfile *per_objfile);
+
+/* Build the contents of the .gdb_index files from DATA, which this
+   consumes.  This only uses DATA, so it may be called from a worker
+   thread.  */
+
+extern gdb_index_contents build_gdb_index_contents (gdb_index_data &data);
+
+/* Write CONTENTS to index files in the directory DIR.  BASENAME and
+   DWZ_BASENAME are as for write_psymtabs_to_index.  Each file is
+   written under a temporary name and then renamed into place, so a
+   concurrent reader never sees a partially written file.
+
+   This only uses its arguments, so it may be called from a worker
+   thread.  Errors are reported by throwing an exception.  */
+
+extern void write_gdb_index_contents (const gdb_index_contents &contents,
+				      const char *dir, const char *basename,
+				      const char *dwz_basename);
+
 #endif /* DWARF_INDEX_WRITE_H */
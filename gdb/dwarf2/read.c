@@ -87,6 +87,7 @@
 #include "gdbsupport/selftest.h"
 #include "rust-lang.h"
 #include "gdbsupport/pathstuff.h"
+#include "gdbsupport/parallel-for.h"
 #include "count-one-bits.h"
 #include <unordered_set>
 
@@ -791,7 +792,8 @@ class cutu_reader : public die_reader_specs
 	       dwarf2_per_objfile *per_objfile,
 	       struct abbrev_table *abbrev_table,
 	       dwarf2_cu *existing_cu,
-	       bool skip_partial);
+	       bool skip_partial,
+	       bool skip_dwo = false);
 
   explicit cutu_reader (struct dwarf2_per_cu_data *this_cu,
 			dwarf2_per_objfile *per_objfile,
@@ -804,6 +806,10 @@ class cutu_reader : public die_reader_specs
   struct die_info *comp_unit_die = nullptr;
   bool dummy_p = false;
 
+  /* True if the unit refers to a DWO file, which was not read because
+     SKIP_DWO was passed to the constructor.  */
+  bool dwo_skipped = false;
+
   /* Release the new CU, putting it on the chain.  This cannot be done
      for dummy CUs.  */
   void keep ();
@@ -1135,7 +1141,8 @@ static void add_partial_subprogram (struct partial_die_info *pdi,
 static unsigned int peek_abbrev_code (bfd *, const gdb_byte *);
 
 static struct partial_die_info *load_partial_dies
-  (const struct die_reader_specs *, const gdb_byte *, int);
+  (const struct die_reader_specs *, const gdb_byte *, int,
+   std::vector<partial_die_info> * = nullptr);
 
 /* A pair of partial_die_info and compilation unit.  */
 struct cu_partial_die_info
@@ -2523,7 +2530,9 @@ create_signatured_type_table_from_debug_names
 }
 
 /* Read the address map data from the mapped index, and use it to
-   populate the psymtabs_addrmap.  */
+   populate the index_addrmap.  This is not done when the index is
+   read, but the first time an address is looked up, see
+   dwarf2_base_index_functions::find_pc_sect_compunit_symtab.  */
 
 static void
 create_addrmap_from_index (dwarf2_per_objfile *per_objfile,
@@ -2945,8 +2954,10 @@ dwarf2_read_gdb_index
 					       types_list_elements);
     }
 
-  create_addrmap_from_index (per_objfile, map.get ());
-
+  /* The address table is only read when it is first needed; the rest
+     of the index is used directly from the (possibly mmapped) buffer.
+     This keeps loading an index cheap, notably for objfiles whose
+     addresses are never looked up.  */
   per_bfd->index_table = std::move (map);
   per_bfd->using_index = 1;
   per_bfd->quick_file_names_table =
@@ -4482,7 +4493,10 @@ dwarf2_base_index_functions::find_pc_sect_compunit_symtab
   struct compunit_symtab *result;
 
   dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (objfile);
-  if (per_objfile->per_bfd->index_addrmap == nullptr)
+  dwarf2_per_bfd *per_bfd = per_objfile->per_bfd;
+  if (per_bfd->index_addrmap == nullptr && per_bfd->index_table != nullptr)
+    create_addrmap_from_index (per_objfile, per_bfd->index_table.get ());
+  if (per_bfd->index_addrmap == nullptr)
     return NULL;
 
   CORE_ADDR baseaddr = objfile->text_section_offset ();
@@ -6515,13 +6529,18 @@ cutu_reader::init_tu_and_read_dwo_dies (dwarf2_per_cu_data *this_cu,
    This is an optimization for when we already have the abbrev table.
 
    If EXISTING_CU is non-NULL, then use it.  Otherwise, a new CU is
-   allocated.  */
+   allocated.
+
+   If SKIP_DWO is true, and the unit refers to a DWO file, stop after
+   reading the skeleton DIE and set DWO_SKIPPED.  This is used on the
+   worker threads, which can't open the DWO files.  */
 
 cutu_reader::cutu_reader (dwarf2_per_cu_data *this_cu,
 			  dwarf2_per_objfile *per_objfile,
 			  struct abbrev_table *abbrev_table,
 			  dwarf2_cu *existing_cu,
-			  bool skip_partial)
+			  bool skip_partial,
+			  bool skip_dwo)
   : die_reader_specs {},
     m_this_cu (this_cu)
 {
@@ -6670,7 +6689,9 @@ cutu_reader::cutu_reader (dwarf2_per_cu_data *this_cu,
      Note that if USE_EXISTING_OK != 0, and THIS_CU->cu already contains a
      DWO CU, that this test will fail (the attribute will not be present).  */
   const char *dwo_name = dwarf2_dwo_name (comp_unit_die, cu);
-  if (dwo_name != nullptr)
+  if (dwo_name != nullptr && skip_dwo)
+    dwo_skipped = true;
+  else if (dwo_name != nullptr)
     {
       struct dwo_unit *dwo_unit;
       struct die_info *dwo_comp_unit_die;
@@ -6962,13 +6983,32 @@ create_partial_symtab (dwarf2_per_cu_data *per_cu,
   return pst;
 }
 
-/* DIE reader function for process_psymtab_comp_unit.  */
+/* A compilation unit whose DIEs were read on a worker thread, see
+   preload_psymtab_comp_units.  */
+
+struct psymtab_preload
+{
+  /* The reader of the unit, which owns its dwarf2_cu and thus the
+     partial DIEs.  NULL if the unit was not read ahead.  */
+  std::unique_ptr<cutu_reader> reader;
+
+  /* The first partial DIE, as returned by load_partial_dies.  */
+  struct partial_die_info *first_die = nullptr;
+
+  /* The DIEs for which load_partial_dies would have added a partial
+     symbol right away, in order.  */
+  std::vector<partial_die_info> deferred_dies;
+};
+
+/* DIE reader function for process_psymtab_comp_unit.  PRELOAD, if not
+   NULL, holds the partial DIEs of the unit, already read.  */
 
 static void
 process_psymtab_comp_unit_reader (const struct die_reader_specs *reader,
 				  const gdb_byte *info_ptr,
 				  struct die_info *comp_unit_die,
-				  enum language pretend_language)
+				  enum language pretend_language,
+				  psymtab_preload *preload = nullptr)
 {
   struct dwarf2_cu *cu = reader->cu;
   dwarf2_per_objfile *per_objfile = cu->per_objfile;
@@ -7035,7 +7075,14 @@ process_psymtab_comp_unit_reader (const struct die_reader_specs *reader,
       lowpc = ((CORE_ADDR) -1);
       highpc = ((CORE_ADDR) 0);
 
-      first_die = load_partial_dies (reader, info_ptr, 1);
+      if (preload != nullptr)
+	{
+	  for (partial_die_info &pdi : preload->deferred_dies)
+	    add_partial_symbol (&pdi, cu);
+	  first_die = preload->first_die;
+	}
+      else
+	first_die = load_partial_dies (reader, info_ptr, 1);
 
       scan_partial_symbols (first_die, &lowpc, &highpc,
 			    cu_bounds_kind <= PC_BOUNDS_INVALID, cu);
@@ -7096,13 +7143,15 @@ process_psymtab_comp_unit_reader (const struct die_reader_specs *reader,
 }
 
 /* Subroutine of dwarf2_build_psymtabs_hard to simplify it.
-   Process compilation unit THIS_CU for a psymtab.  */
+   Process compilation unit THIS_CU for a psymtab.  PRELOAD, if not
+   NULL, holds the unit as read by preload_psymtab_comp_units.  */
 
 static void
 process_psymtab_comp_unit (dwarf2_per_cu_data *this_cu,
 			   dwarf2_per_objfile *per_objfile,
 			   bool want_partial_unit,
-			   enum language pretend_language)
+			   enum language pretend_language,
+			   psymtab_preload *preload = nullptr)
 {
   /* If this compilation unit was already read in, free the
      cached copy in order to read it in again.	This is
@@ -7111,7 +7160,11 @@ process_psymtab_comp_unit (dwarf2_per_cu_data *this_cu,
      This problem could be avoided, but the benefit is unclear.  */
   per_objfile->remove_cu (this_cu);
 
-  cutu_reader reader (this_cu, per_objfile, nullptr, nullptr, false);
+  gdb::optional<cutu_reader> local_reader;
+  if (preload == nullptr)
+    local_reader.emplace (this_cu, per_objfile, nullptr, nullptr, false);
+  cutu_reader &reader = (preload != nullptr
+			 ? *preload->reader : *local_reader);
 
   if (reader.comp_unit_die == nullptr)
     return;
@@ -7145,7 +7198,7 @@ process_psymtab_comp_unit (dwarf2_per_cu_data *this_cu,
 	   || reader.comp_unit_die->tag != DW_TAG_partial_unit)
     process_psymtab_comp_unit_reader (&reader, reader.info_ptr,
 				      reader.comp_unit_die,
-				      pretend_language);
+				      pretend_language, preload);
 
   /* Age out any secondary CUs.  */
   per_objfile->age_comp_units ();
@@ -7446,6 +7499,113 @@ set_partial_user (dwarf2_per_objfile *per_objfile)
     }
 }
 
+/* The maximum number of compilation units, and of bytes of
+   .debug_info, read ahead by preload_psymtab_comp_units in one batch.
+   This bounds the memory used by partial DIEs that have been read but
+   not yet used.  */
+
+static const size_t psymtab_preload_max_units = 1024;
+static const size_t psymtab_preload_max_bytes = 64 * 1024 * 1024;
+
+/* Read the partial DIEs of the compilation units in the range
+   [FIRST, LAST) of PER_OBJFILE's all_comp_units, using the thread
+   pool.  Entry I of the result corresponds to unit FIRST + I.
+
+   Only the work which touches nothing but the unit itself is done
+   here: reading its header, its abbreviation table and its partial
+   DIEs, which go on the unit's own obstack.  The partial symbols of
+   the DIEs load_partial_dies handles right away are deferred, as are
+   the psymtab itself, the other partial symbols, whose names are
+   interned in the objfile, and the references to other units: these
+   are left to process_psymtab_comp_unit, on the main thread.
+
+   Units which can't be read this way, like the ones referring to a
+   DWO file or which have already been read, and the ones whose DIEs
+   are malformed, get an empty entry.  process_psymtab_comp_unit then
+   reads them itself, and reports any error, as it would otherwise
+   have done.  */
+
+static std::vector<psymtab_preload>
+preload_psymtab_comp_units (dwarf2_per_objfile *per_objfile,
+			    size_t first, size_t last)
+{
+  struct objfile *objfile = per_objfile->objfile;
+  dwarf2_per_bfd *per_bfd = per_objfile->per_bfd;
+
+  /* Read the sections the DIEs may refer to up front, this can't be
+     done in the worker threads.  */
+  for (dwarf2_section_info *section : { &per_bfd->abbrev, &per_bfd->str,
+					&per_bfd->str_offsets,
+					&per_bfd->line_str, &per_bfd->addr,
+					&per_bfd->loc, &per_bfd->loclists,
+					&per_bfd->ranges,
+					&per_bfd->rnglists })
+    section->read (objfile);
+  dwz_file *dwz = dwarf2_get_dwz_file (per_bfd);
+  if (dwz != nullptr)
+    for (dwarf2_section_info *section : { &dwz->info, &dwz->abbrev,
+					  &dwz->str })
+      section->read (objfile);
+
+  std::vector<psymtab_preload> result (last - first);
+
+  /* The time it takes to read a unit depends on its size.  */
+  auto estimate_size = [&] (size_t i) -> size_t
+    {
+      return per_bfd->all_comp_units[i]->length + 1;
+    };
+  gdb::function_view<size_t (size_t)> task_size = estimate_size;
+
+  gdb::parallel_for_each
+    (first, last,
+     [&] (size_t start, size_t end)
+     {
+       for (size_t i = start; i < end; ++i)
+	 {
+	   dwarf2_per_cu_data *per_cu = per_bfd->all_comp_units[i].get ();
+
+	   if (per_cu->is_debug_types
+	       || per_cu->v.psymtab != nullptr
+	       || (per_cu->is_dwz && dwz == nullptr)
+	       || per_cu->section->buffer == nullptr
+	       || per_objfile->get_cu (per_cu) != nullptr)
+	     continue;
+
+	   try
+	     {
+	       psymtab_preload preload;
+	       preload.reader.reset (new cutu_reader (per_cu, per_objfile,
+						      nullptr, nullptr,
+						      false, true));
+	       cutu_reader *reader = preload.reader.get ();
+
+	       /* Partial units are read with the language of the unit
+		  importing them.  */
+	       if (reader->dummy_p
+		   || reader->dwo_skipped
+		   || reader->comp_unit_die->tag != DW_TAG_compile_unit)
+		 continue;
+
+	       prepare_one_comp_unit (reader->cu, reader->comp_unit_die,
+				      language_minimal);
+	       if (reader->comp_unit_die->has_children)
+		 preload.first_die = load_partial_dies (reader,
+							reader->info_ptr, 1,
+							&preload.deferred_dies);
+
+	       result[i - first] = std::move (preload);
+	     }
+	   catch (const gdb_exception &)
+	     {
+	       /* Leave it to process_psymtab_comp_unit.  */
+	     }
+	 }
+     },
+     task_size);
+
+  return result;
+}
+
 /* Build the partial symbol table by doing a quick pass through the
    .debug_info and .debug_abbrev sections.  */
 
@@ -7478,13 +7638,46 @@ dwarf2_build_psymtabs_hard (dwarf2_per_objfile *per_objfile)
     = make_scoped_restore (&per_bfd->partial_symtabs->psymtabs_addrmap,
 			   addrmap_create_mutable (&temp_obstack));
 
-  for (const auto &per_cu : per_bfd->all_comp_units)
+  /* Creating the psymtabs and the partial symbols has to be done
+     serially, but the DIEs of a batch of units can be read in parallel
+     beforehand.  Complaints and the DIE debugging output can't be
+     printed from the worker threads, so the DIEs are read serially
+     when they are enabled.  */
+  bool preload = stop_whining == 0 && dwarf_die_debug == 0;
+  size_t n_units = per_bfd->all_comp_units.size ();
+  size_t batch_end;
+  for (size_t batch = 0; batch < n_units; batch = batch_end)
     {
-      if (per_cu->v.psymtab != NULL)
-	/* In case a forward DW_TAG_imported_unit has read the CU already.  */
-	continue;
-      process_psymtab_comp_unit (per_cu.get (), per_objfile, false,
-				 language_minimal);
+      size_t batch_bytes = 0;
+      for (batch_end = batch;
+	   (batch_end < n_units
+	    && batch_end - batch < psymtab_preload_max_units
+	    && batch_bytes < psymtab_preload_max_bytes);
+	   ++batch_end)
+	batch_bytes += per_bfd->all_comp_units[batch_end]->length;
+
+      std::vector<psymtab_preload> preloads;
+      if (preload)
+	preloads = preload_psymtab_comp_units (per_objfile, batch,
+					       batch_end);
+
+      for (size_t i = batch; i < batch_end; ++i)
+	{
+	  dwarf2_per_cu_data *per_cu = per_bfd->all_comp_units[i].get ();
+	  psymtab_preload *unit_preload = nullptr;
+	  if (preload && preloads[i - batch].reader != nullptr)
+	    unit_preload = &preloads[i - batch];
+
+	  if (per_cu->v.psymtab == NULL)
+	    process_psymtab_comp_unit (per_cu, per_objfile, false,
+				       language_minimal, unit_preload);
+	  /* Otherwise, a forward DW_TAG_imported_unit has read the CU
+	     already.  */
+
+	  /* The DIEs are no longer needed.  */
+	  if (unit_preload != nullptr)
+	    *unit_preload = psymtab_preload ();
+	}
     }
 
   /* This has to wait until we read the CUs, we need the list of DWOs.  */
@@ -19023,11 +19216,16 @@ is_type_tag_for_partial (int tag, enum language lang)
     }
 }
 
-/* Load all DIEs that are interesting for partial symbols into memory.  */
+/* Load all DIEs that are interesting for partial symbols into memory.
+
+   If DEFERRED is not NULL, the DIEs for which a partial symbol would
+   be added right away are appended to it instead, so that the caller
+   can add the symbols later; see preload_psymtab_comp_units.  */
 
 static struct partial_die_info *
 load_partial_dies (const struct die_reader_specs *reader,
-		   const gdb_byte *info_ptr, int building_psymtab)
+		   const gdb_byte *info_ptr, int building_psymtab,
+		   std::vector<partial_die_info> *deferred)
 {
   struct dwarf2_cu *cu = reader->cu;
   struct objfile *objfile = cu->per_objfile->objfile;
@@ -19152,7 +19350,12 @@ load_partial_dies (const struct die_reader_specs *reader,
 	      || pdi.tag == DW_TAG_subrange_type))
 	{
 	  if (building_psymtab && pdi.raw_name != NULL)
-	    add_partial_symbol (&pdi, cu);
+	    {
+	      if (deferred != nullptr)
+		deferred->push_back (pdi);
+	      else
+		add_partial_symbol (&pdi, cu);
+	    }
 
 	  info_ptr = locate_pdi_sibling (reader, &pdi, info_ptr);
 	  continue;
@@ -19183,6 +19386,8 @@ load_partial_dies (const struct die_reader_specs *reader,
 	{
 	  if (pdi.raw_name == NULL)
 	    complaint (_("malformed enumerator DIE ignored"));
+	  else if (building_psymtab && deferred != nullptr)
+	    deferred->push_back (pdi);
 	  else if (building_psymtab)
 	    add_partial_symbol (&pdi, cu);
 
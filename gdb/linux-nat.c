@@ -54,6 +54,7 @@
 #include <dirent.h>
 #include "xml-support.h"
 #include <sys/vfs.h>
+#include <sys/uio.h>
 #include "solib.h"
 #include "nat/linux-osdata.h"
 #include "linux-tdep.h"
@@ -3943,6 +3944,137 @@ linux_proc_xfer_memory_partial (gdb_byte *readbuf, const gdb_byte *writebuf,
     }
 }
 
+/* Whether process_vm_readv can be used.  Cleared the first time the
+   kernel says it isn't implemented or isn't allowed.  */
+
+static bool use_process_vm_readv = true;
+
+/* Return true if the memory of process PID can be read with
+   process_vm_readv.  Unlike the /proc/PID/mem file, which stays tied
+   to the address space it was opened for, process_vm_readv accesses
+   whatever address space PID has now.  So only use it when the whole
+   process is stopped, and none of its LWPs has an exec event pending:
+   then the address space can't be one GDB doesn't know about yet.  */
+
+static bool
+can_use_process_vm_readv (int pid)
+{
+  if (!use_process_vm_readv)
+    return false;
+
+  for (lwp_info *lp : all_lwps ())
+    {
+      if (lp->ptid.pid () != pid)
+	continue;
+
+      if (!lp->stopped
+	  || lp->waitstatus.kind () == TARGET_WAITKIND_EXECD)
+	return false;
+    }
+
+  return true;
+}
+
+/* Read as many of REQUESTS as possible, in order, with a single
+   process_vm_readv call on process PID.  There must be at most IOV_MAX
+   requests.  Return the number of requests that were completely read,
+   setting their XFERED_LEN, or -1 if process_vm_readv can't be used
+   for this process at all.  */
+
+static int
+linux_proc_read_memory_batch (int pid,
+			      gdb::array_view<memory_batch_request> requests)
+{
+  size_t count = requests.size ();
+  std::vector<struct iovec> local (count);
+  std::vector<struct iovec> remote (count);
+
+  /* Mask the addresses like linux_nat_target::xfer_partial does.  */
+  CORE_ADDR addr_mask = ~(CORE_ADDR) 0;
+  int addr_bit = gdbarch_addr_bit (target_gdbarch ());
+  if (addr_bit < (sizeof (ULONGEST) * HOST_CHAR_BIT))
+    addr_mask = ((ULONGEST) 1 << addr_bit) - 1;
+
+  gdb_assert (count <= IOV_MAX);
+  for (size_t i = 0; i < count; i++)
+    {
+      local[i].iov_base = requests[i].buf;
+      local[i].iov_len = requests[i].len;
+      remote[i].iov_base = (void *) (uintptr_t) (requests[i].addr & addr_mask);
+      remote[i].iov_len = requests[i].len;
+    }
+
+  ssize_t ret = process_vm_readv (pid, local.data (), count,
+				  remote.data (), count, 0);
+  if (ret == -1)
+    {
+      linux_nat_debug_printf ("process_vm_readv for pid %d failed: %s (%d)",
+			      pid, safe_strerror (errno), errno);
+      if (errno == ENOSYS || errno == EPERM)
+	{
+	  use_process_vm_readv = false;
+	  return -1;
+	}
+
+      /* Most likely EFAULT, the first range couldn't be read at all.
+	 This says nothing about the other ones.  */
+      return 0;
+    }
+
+  /* The kernel fills the ranges in order, and stops at the first one
+     it can't read completely.  */
+  size_t done = 0;
+  for (; done < count && (size_t) ret >= requests[done].len; done++)
+    {
+      requests[done].xfered_len = requests[done].len;
+      ret -= requests[done].len;
+    }
+
+  linux_nat_debug_printf ("read %zu of %zu ranges with process_vm_readv",
+			  done, count);
+  return done;
+}
+
+/* Implement the xfer_memory_batch target method.  Read as many of the
+   ranges as possible with one process_vm_readv call each, and the
+   ones it can't read, e.g. because they span unmapped pages that the
+   lower targets can provide, through the usual path.  */
+
+void
+linux_nat_target::xfer_memory_batch
+  (gdb::array_view<memory_batch_request> requests)
+{
+  if (inferior_ptid == null_ptid
+      || !can_use_process_vm_readv (inferior_ptid.pid ()))
+    {
+      default_xfer_memory_batch (this, requests);
+      return;
+    }
+
+  while (!requests.empty ())
+    {
+      size_t count = std::min (requests.size (), (size_t) IOV_MAX);
+      int done = linux_proc_read_memory_batch (inferior_ptid.pid (),
+					       requests.slice (0, count));
+      if (done == -1)
+	{
+	  default_xfer_memory_batch (this, requests);
+	  return;
+	}
+
+      requests = requests.slice (done);
+      if ((size_t) done < count)
+	{
+	  /* The first remaining request could only be read partially,
+	     if at all.  Let the usual path, and the other targets, have
+	     a go at it, then continue with the rest in a single call
+	     again.  */
+	  default_xfer_memory_batch (this, requests.slice (0, 1));
+	  requests = requests.slice (1);
+	}
+    }
+}
+
 /* Parse LINE as a signal set and add its set bits to SIGS.  */
 
 static void
@@ -1462,6 +1462,19 @@ minimal_symbol_reader::install ()
 
       std::vector<computed_hash_values> hash_values (mcount);
 
+      /* Most of the work done for a symbol is demangling its name, and
+	 the cost of that grows with the length of the name.  Split the
+	 work accordingly, otherwise the threads that get the long C++
+	 template names lag behind the others.  */
+      auto estimate_size = [] (minimal_symbol *msym) -> size_t
+	{
+	  if (msym->name_set)
+	    return 1;
+	  return strlen (msym->linkage_name ()) + 1;
+	};
+      gdb::function_view<size_t (minimal_symbol *)> task_size
+	= estimate_size;
+
       msymbols = m_objfile->per_bfd->msymbols.get ();
       gdb::parallel_for_each
 	(&msymbols[0], &msymbols[mcount],
@@ -1513,7 +1526,8 @@ minimal_symbol_reader::install ()
 		    hash_values[idx].mangled_name_hash);
 	       }
 	   }
-	 });
+	 },
+	 task_size);
 
       build_minimal_symbol_hash_tables (m_objfile, hash_values);
     }
@@ -102,6 +102,8 @@ class record_btrace_target final : public target_ops
 					ULONGEST offset, ULONGEST len,
 					ULONGEST *xfered_len) override;
 
+  void xfer_memory_batch (gdb::array_view<memory_batch_request>) override;
+
   int insert_breakpoint (struct gdbarch *,
 			 struct bp_target_info *) override;
   int remove_breakpoint (struct gdbarch *, struct bp_target_info *,
@@ -1474,6 +1476,22 @@ record_btrace_target::xfer_partial (enum target_object object,
 					 offset, len, xfered_len);
 }
 
+/* The xfer_memory_batch method of target record-btrace.  */
+
+void
+record_btrace_target::xfer_memory_batch
+  (gdb::array_view<memory_batch_request> requests)
+{
+  /* During replay, memory reads must go through xfer_partial above, to
+     be filtered.  */
+  if (replay_memory_access == replay_memory_access_read_only
+      && !record_btrace_generating_corefile
+      && record_is_replaying (inferior_ptid))
+    default_xfer_memory_batch (this, requests);
+  else
+    this->beneath ()->xfer_memory_batch (requests);
+}
+
 /* The insert_breakpoint method of target record-btrace.  */
 
 int
@@ -43,7 +43,12 @@
 #include "target-descriptions.h"
 #include "gdb_bfd.h"
 #include "gdbsupport/filestuff.h"
+#include "gdbsupport/fileio.h"
+#include "gdbsupport/gdb_unlinker.h"
+#include "gdbsupport/pathstuff.h"
 #include "gdbsupport/rsp-low.h"
+#include "elf/common.h"
+#include "elf/external.h"
 #include "disasm.h"
 #include "location.h"
 
@@ -57,6 +62,7 @@
 #include "serial.h"
 
 #include "gdbcore.h"
+#include "user-regs.h"
 
 #include "remote-fileio.h"
 #include "gdb/fileio.h"
@@ -78,8 +84,10 @@
 #include "gdbsupport/search.h"
 #include <algorithm>
 #include <unordered_map>
+#include <list>
 #include "async-event.h"
 #include "gdbsupport/selftest.h"
+#include <zlib.h>
 
 /* The remote target.  */
 
@@ -160,32 +168,104 @@ struct readahead_cache
   /* Invalidate the readahead cache.  */
   void invalidate ();
 
-  /* Invalidate the readahead cache if it is holding data for FD.  */
+  /* Invalidate the readahead cache blocks holding data for FD.  */
   void invalidate_fd (int fd);
 
   /* Serve pread from the readahead cache.  Returns number of bytes
      read, or 0 if the request can't be served from the cache.  */
   int pread (int fd, gdb_byte *read_buf, size_t len, ULONGEST offset);
 
-  /* The file descriptor for the file that is being cached.  -1 if the
-     cache is invalid.  */
-  int fd = -1;
+  /* Add a block of data read from FD at OFFSET to the cache, evicting
+     the least recently used block if the cache is full.  */
+  void add (int fd, ULONGEST offset, gdb::byte_vector &&data);
 
-  /* The offset into the file that the cache buffer corresponds
-     to.  */
-  ULONGEST offset = 0;
+  /* Return the number of blocks in the cache that hold the data of
+     FD just before OFFSET, one after the other.  A nonzero value
+     means that the file is being read sequentially.  */
+  unsigned int sequential_blocks (int fd, ULONGEST offset) const;
+
+  /* Return the offset of the first block in the cache holding data of
+     FD after OFFSET, or ULONGEST_MAX if there is none.  Reads that
+     fill the gap before a block should stop there.  */
+  ULONGEST next_block_offset (int fd, ULONGEST offset) const;
+
+  /* A block of data read from a file.  */
+  struct block
+  {
+    /* The file descriptor.  */
+    int fd;
+
+    /* The offset into the file that the block corresponds to.  */
+    ULONGEST offset;
+
+    /* The block's contents.  Its size is the number of bytes the
+       target returned, usually as much as fits into a packet.  */
+    gdb::byte_vector data;
+  };
+
+  /* The cached blocks, the most recently used one first.  */
+  std::list<block> blocks;
 
-  /* The buffer holding the cache contents.  */
-  gdb_byte *buf = nullptr;
-  /* The buffer's size.  We try to read as much as fits into a packet
-     at a time.  */
-  size_t bufsize = 0;
+  /* The maximum number of blocks in the cache.  */
+  static constexpr size_t max_blocks = 64;
 
   /* Cache hit and miss counters.  */
   ULONGEST hit_count = 0;
   ULONGEST miss_count = 0;
 };
 
+/* A file open on the target whose contents are read from a copy in
+   the local file cache instead, see "set remote file-cache".  */
+
+struct remote_cached_file
+{
+  /* The local copy of the file.  */
+  scoped_fd fd;
+
+  /* The status of the file on the target, returned by fileio_fstat
+     without asking the target again.  */
+  struct stat st;
+};
+
+/* The memory from the stack pointer sent in the last stop reply, as
+   asked with the QExpediteStack packet.  Reads of it are served
+   without asking the stub, until the inferior is resumed or its
+   memory written.  */
+
+struct remote_stack_snapshot
+{
+  /* If ADDR in process PID is in the snapshot, copy up to LEN bytes
+     from there to BUF, set *XFERED_LEN to the number copied, and
+     return true.  */
+  bool read (int pid, CORE_ADDR addr, gdb_byte *buf, ULONGEST len,
+	     ULONGEST *xfered_len) const
+  {
+    if (data.empty ()
+	|| pid != this->pid
+	|| addr < this->addr
+	|| addr - this->addr >= data.size ())
+      return false;
+
+    ULONGEST offset = addr - this->addr;
+    *xfered_len = std::min (len, (ULONGEST) data.size () - offset);
+    memcpy (buf, data.data () + offset, *xfered_len);
+    return true;
+  }
+
+  /* Forget the contents.  */
+  void clear ()
+  {
+    data.clear ();
+  }
+
+  /* The process and address the snapshot was taken at.  */
+  int pid = 0;
+  CORE_ADDR addr = 0;
+
+  /* The contents of the memory.  */
+  gdb::byte_vector data;
+};
+
 /* Description of the remote protocol for a given architecture.  */
 
 struct packet_reg
@@ -263,6 +343,10 @@ class remote_state
      reliable.  */
   bool noack_mode = false;
 
+  /* True if the stub was asked to compress large replies, with the
+     QCompressReplies packet.  */
+  bool compressed_replies = false;
+
   /* True if we're connected in extended remote mode.  */
   bool extended = false;
 
@@ -355,10 +439,24 @@ class remote_state
      involves a sequence of small reads.  E.g., when parsing an ELF
      file.  A readahead cache helps mostly the case of remote
      debugging on a connection with higher latency, due to the
-     request/reply nature of the RSP.  We only cache data for a single
-     file descriptor at a time.  */
+     request/reply nature of the RSP.  BFD reads the different parts
+     of a file, such as the section headers, the symbol table and the
+     debug sections, in turns, so several blocks of several files are
+     kept.  */
   struct readahead_cache readahead_cache;
 
+  /* The files open on the target that are read from the local file
+     cache, indexed by the target's file descriptor.  */
+  std::unordered_map<int, remote_cached_file> cached_files;
+
+  /* The stack contents sent with the last stop reply, in all-stop
+     mode.  */
+  remote_stack_snapshot stack_snapshot;
+
+  /* The value of remote_expedite_generation when the QExpediteRegisters
+     and QExpediteStack packets were last sent.  */
+  unsigned int expedite_generation = 0;
+
   /* The list of already fetched and acknowledged stop events.  This
      queue is used for notification Stop, and other notifications
      don't need queue for their events, because the notification
@@ -504,6 +602,8 @@ class remote_target : public process_stratum_target
 					ULONGEST offset, ULONGEST len,
 					ULONGEST *xfered_len) override;
 
+  void xfer_memory_batch (gdb::array_view<memory_batch_request>) override;
+
   ULONGEST get_memory_xfer_limit () override;
 
   void rcmd (const char *command, struct ui_file *output) override;
@@ -706,10 +806,15 @@ class remote_target : public process_stratum_target
 			    ULONGEST offset, int *remote_errno);
   int remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
 				 ULONGEST offset, int *remote_errno);
+  int remote_hostio_pread_pipelined (int fd, ULONGEST offset,
+				     unsigned int n_blocks,
+				     int *remote_errno);
 
   int remote_hostio_send_command (int command_bytes, int which_packet,
 				  int *remote_errno, const char **attachment,
 				  int *attachment_len);
+  int remote_hostio_get_reply (int which_packet, int *remote_errno,
+			       const char **attachment, int *attachment_len);
   int remote_hostio_set_filesystem (struct inferior *inf,
 				    int *remote_errno);
   /* We should get rid of this and use fileio_open directly.  */
@@ -717,6 +822,14 @@ class remote_target : public process_stratum_target
 			  int flags, int mode, int warn_if_slow,
 			  int *remote_errno);
   int remote_hostio_close (int fd, int *remote_errno);
+  int remote_hostio_fstat (int fd, struct stat *st, int *remote_errno);
+
+  void remote_file_cache_open (int fd, const char *filename);
+  bool remote_file_read_fully (int fd, gdb_byte *buf, int len,
+			       ULONGEST offset);
+  std::string remote_file_build_id (int fd);
+  bool remote_file_cache_fetch (int fd, const struct stat &st,
+				const std::string &cache_filename);
 
   int remote_hostio_unlink (inferior *inf, const char *filename,
 			    int *remote_errno);
@@ -839,6 +952,8 @@ class remote_target : public process_stratum_target
 
   void remote_vcont_probe ();
 
+  void send_expedite_requests ();
+
   void remote_resume_with_hc (ptid_t ptid, int step,
 			      gdb_signal siggnal);
 
@@ -877,6 +992,19 @@ class remote_target : public process_stratum_target
 					  ULONGEST len_units,
 					  int unit_size, ULONGEST *xfered_len_units);
 
+  target_xfer_status remote_read_bytes_pipelined (CORE_ADDR memaddr,
+						  gdb_byte *myaddr,
+						  ULONGEST len_units,
+						  int unit_size,
+						  ULONGEST packet_units,
+						  ULONGEST *xfered_len_units);
+
+  bool read_stack_snapshot (CORE_ADDR memaddr, gdb_byte *myaddr,
+			    ULONGEST len, ULONGEST *xfered_len);
+
+  bool remote_read_memory_ranges
+    (gdb::array_view<memory_batch_request> requests);
+
   target_xfer_status remote_xfer_live_readonly_partial (gdb_byte *readbuf,
 							ULONGEST memaddr,
 							ULONGEST len,
@@ -909,6 +1037,7 @@ class remote_target : public process_stratum_target
 
   void skip_frame ();
   long read_frame (gdb::char_vector *buf_p);
+  long inflate_frame (gdb::char_vector *buf_p, long bc);
   void getpkt (gdb::char_vector *buf, int forever);
   int getpkt_or_notif_sane_1 (gdb::char_vector *buf, int forever,
 			      int expecting_notif, int *is_notif);
@@ -1014,6 +1143,10 @@ struct stop_reply : public notif_event
   CORE_ADDR watch_data_address;
 
   int core;
+
+  /* The memory from the stack pointer, if the stub sent it.  */
+  CORE_ADDR stack_addr;
+  gdb::byte_vector stack;
 };
 
 /* See remote.h.  */
@@ -2211,6 +2344,25 @@ enum {
      packets and the tag violation stop replies.  */
   PACKET_memory_tagging_feature,
 
+  /* Support for sending several memory read packets before reading
+     their replies.  */
+  PACKET_pipelined_memory_reads,
+
+  /* Support for sending several vFile:pread packets before reading
+     their replies.  */
+  PACKET_pipelined_file_reads,
+
+  /* Support for reading several memory ranges with one packet.  */
+  PACKET_vReadMemory,
+
+  /* Support for compressed replies.  */
+  PACKET_QCompressReplies,
+
+  /* Support for sending more registers and the top of the stack in
+     stop replies.  */
+  PACKET_QExpediteRegisters,
+  PACKET_QExpediteStack,
+
   PACKET_MAX
 };
 
@@ -4808,6 +4960,18 @@ remote_target::start_remote_1 (int from_tty, int extended_p)
 	rs->noack_mode = 1;
     }
 
+  /* Ask the stub to compress large replies, if it supports it.  This
+     is mostly useful on slow links, replies such as large memory reads
+     and file transfers shrink a lot.  */
+  if (packet_support (PACKET_QCompressReplies) != PACKET_DISABLE)
+    {
+      putpkt ("QCompressReplies:zlib");
+      getpkt (&rs->buf, 0);
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_QCompressReplies])
+	  == PACKET_OK)
+	rs->compressed_replies = true;
+    }
+
   if (extended_p)
     {
       /* Tell the remote that we are using the extended protocol.  */
@@ -5409,6 +5573,18 @@ static const struct protocol_feature remote_protocol_features[] = {
   { "no-resumed", PACKET_DISABLE, remote_supported_packet, PACKET_no_resumed },
   { "memory-tagging", PACKET_DISABLE, remote_supported_packet,
     PACKET_memory_tagging_feature },
+  { "pipelined-memory-reads", PACKET_DISABLE, remote_supported_packet,
+    PACKET_pipelined_memory_reads },
+  { "pipelined-file-reads", PACKET_DISABLE, remote_supported_packet,
+    PACKET_pipelined_file_reads },
+  { "vReadMemory", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vReadMemory },
+  { "QCompressReplies", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QCompressReplies },
+  { "QExpediteRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QExpediteRegisters },
+  { "QExpediteStack", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QExpediteStack },
 };
 
 static char *remote_support_xml;
@@ -5801,6 +5977,7 @@ remote_target::open_1 (const char *name, int from_tty, int extended_p)
   reset_all_packet_configs_support ();
   rs->explicit_packet_size = 0;
   rs->noack_mode = 0;
+  rs->compressed_replies = false;
   rs->extended = extended_p;
   rs->waiting_for_stop_reply = 0;
   rs->ctrlc_pending_p = 0;
@@ -5817,6 +5994,7 @@ remote_target::open_1 (const char *name, int from_tty, int extended_p)
   rs->use_threadextra_query = 1;
 
   rs->readahead_cache.invalidate ();
+  rs->cached_files.clear ();
 
   if (target_async_permitted)
     {
@@ -6518,6 +6696,107 @@ remote_target::remote_resume_with_vcont (ptid_t ptid, int step,
   return 1;
 }
 
+/* The registers to ask the remote stub to send in stop replies, in
+   addition to the ones it sends anyway, see "set remote
+   expedited-registers".  */
+
+static std::string remote_expedited_registers;
+
+/* The number of bytes from the stack pointer to ask the remote stub
+   to send in stop replies, see "set remote expedited-stack-size".  */
+
+static unsigned int remote_expedited_stack_size = 0;
+
+/* Incremented when one of the two settings above changes, so that
+   the stub is told before the next resume.  */
+
+static unsigned int remote_expedite_generation = 0;
+
+static void
+set_remote_expedite (const char *args, int from_tty,
+		     struct cmd_list_element *c)
+{
+  remote_expedite_generation++;
+}
+
+/* Send the QExpediteRegisters and QExpediteStack packets, if the
+   settings they implement changed since they were last sent on this
+   connection.  */
+
+void
+remote_target::send_expedite_requests ()
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (rs->expedite_generation == remote_expedite_generation)
+    return;
+  rs->expedite_generation = remote_expedite_generation;
+
+  struct gdbarch *gdbarch = target_gdbarch ();
+  remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
+
+  if (packet_support (PACKET_QExpediteRegisters) != PACKET_DISABLE)
+    {
+      std::string buf = "QExpediteRegisters:";
+      bool first = true;
+
+      gdb_argv argv (remote_expedited_registers.c_str ());
+      for (const char *name : argv)
+	{
+	  if (*name == '\0')
+	    continue;
+
+	  int regnum = user_reg_map_name_to_regnum (gdbarch, name, -1);
+	  if (regnum < 0
+	      || regnum >= gdbarch_num_regs (gdbarch)
+	      || rsa->regs[regnum].pnum < 0)
+	    {
+	      warning (_("Register \"%s\" can't be expedited."), name);
+	      continue;
+	    }
+
+	  if (!first)
+	    buf += ';';
+	  first = false;
+	  buf += phex_nz (rsa->regs[regnum].pnum, 0);
+	}
+
+      if (buf.size () < get_remote_packet_size ())
+	{
+	  putpkt (buf.c_str ());
+	  getpkt (&rs->buf, 0);
+	  packet_config *config
+	    = &remote_protocol_packets[PACKET_QExpediteRegisters];
+	  if (packet_ok (rs->buf, config) == PACKET_ERROR)
+	    warning (_("Remote failure reply: %s"), rs->buf.data ());
+	}
+    }
+
+  if (packet_support (PACKET_QExpediteStack) != PACKET_DISABLE)
+    {
+      int sp_regnum = gdbarch_sp_regnum (gdbarch);
+
+      if (sp_regnum >= 0
+	  && sp_regnum < gdbarch_num_regs (gdbarch)
+	  && rsa->regs[sp_regnum].pnum >= 0)
+	{
+	  /* In non-stop mode, the other threads could change the stack
+	     while GDB looks at the stopped one.  */
+	  unsigned int size = (target_is_non_stop_p ()
+			       ? 0 : remote_expedited_stack_size);
+
+	  xsnprintf (rs->buf.data (), get_remote_packet_size (),
+		     "QExpediteStack:%s,%x",
+		     phex_nz (rsa->regs[sp_regnum].pnum, 0), size);
+	  putpkt (rs->buf);
+	  getpkt (&rs->buf, 0);
+	  packet_config *config = &remote_protocol_packets[PACKET_QExpediteStack];
+	  if (packet_ok (rs->buf, config) == PACKET_ERROR)
+	    warning (_("Remote failure reply: %s"), rs->buf.data ());
+	}
+    }
+}
+
 /* Tell the remote machine to resume.  */
 
 void
@@ -6525,6 +6804,9 @@ remote_target::resume (ptid_t ptid, int step, enum gdb_signal siggnal)
 {
   struct remote_state *rs = get_remote_state ();
 
+  rs->stack_snapshot.clear ();
+  send_expedite_requests ();
+
   /* When connected in non-stop mode, the core resumes threads
      individually.  Resuming remote threads directly in target_resume
      would thus result in sending one packet per thread.  Instead, to
@@ -7515,6 +7797,7 @@ remote_target::remote_parse_stop_reply (const char *buf, stop_reply *event)
   event->stop_reason = TARGET_STOPPED_BY_NO_REASON;
   event->regcache.clear ();
   event->core = -1;
+  event->stack.clear ();
 
   switch (buf[0])
     {
@@ -7656,6 +7939,20 @@ Packet: '%s'\n"),
 	      event->ws.set_thread_created ();
 	      p = strchrnul (p1 + 1, ';');
 	    }
+	  else if (strprefix (p, p1, "stack"))
+	    {
+	      ULONGEST stack_addr;
+
+	      p = unpack_varlen_hex (++p1, &stack_addr);
+	      if (*p != ',')
+		error (_("Malformed stack field in stop reply: %s"), buf);
+	      p1 = strchrnul (++p, ';');
+
+	      event->stack_addr = stack_addr;
+	      event->stack.resize ((p1 - p) / 2);
+	      hex2bin (p, event->stack.data (), event->stack.size ());
+	      p = p1;
+	    }
 	  else
 	    {
 	      ULONGEST pnum;
@@ -8074,6 +8371,15 @@ remote_target::process_stop_reply (struct stop_reply *stop_reply,
       remote_thr->stop_reason = stop_reply->stop_reason;
       remote_thr->watch_data_address = stop_reply->watch_data_address;
 
+      /* In non-stop mode, other threads may change the memory.  */
+      struct remote_state *rs = get_remote_state ();
+      if (!target_is_non_stop_p () && !stop_reply->stack.empty ())
+	{
+	  rs->stack_snapshot.pid = ptid.pid ();
+	  rs->stack_snapshot.addr = stop_reply->stack_addr;
+	  rs->stack_snapshot.data = std::move (stop_reply->stack);
+	}
+
       if (target_is_non_stop_p ())
 	{
 	  /* If the target works in non-stop mode, a stop-reply indicates that
@@ -9123,6 +9429,8 @@ remote_target::remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr,
 {
   const char *packet_format = NULL;
 
+  get_remote_state ()->stack_snapshot.clear ();
+
   /* Check whether the target supports binary download.  */
   check_binary_download (memaddr);
 
@@ -9160,6 +9468,39 @@ remote_target::remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr,
    See the comment of remote_write_bytes_aux for an example of
    memory read/write exchange between gdb and the stub.  */
 
+/* The maximum number of memory read packets in flight, see
+   remote_read_bytes_pipelined.  */
+
+static unsigned int remote_memory_read_pipeline_depth = 8;
+
+/* The maximum number of vFile:pread packets in flight, see
+   remote_hostio_pread_pipelined.  */
+
+static unsigned int remote_file_read_pipeline_depth = 8;
+
+/* The largest value of the two settings above.  Each packet in flight
+   takes a reply buffer, and the stub must queue that many replies, so
+   there is no point in going much further than what fills a fast
+   link.  */
+
+#define MAX_READ_PIPELINE_DEPTH 64
+
+/* Implement the "set remote memory-read-pipeline-depth" and "set remote
+   file-read-pipeline-depth" commands.  Reduce a depth which is too
+   large to MAX_READ_PIPELINE_DEPTH.  */
+
+static void
+set_read_pipeline_depth (const char *args, int from_tty,
+			 struct cmd_list_element *c)
+{
+  if (c->var->get<unsigned int> () > MAX_READ_PIPELINE_DEPTH)
+    {
+      c->var->set<unsigned int> (MAX_READ_PIPELINE_DEPTH);
+      error (_("%s set too high, reducing to %d packets"),
+	     c->name, MAX_READ_PIPELINE_DEPTH);
+    }
+}
+
 target_xfer_status
 remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
 				    ULONGEST len_units,
@@ -9179,6 +9520,17 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   todo_units = std::min (len_units,
 			 (ULONGEST) (buf_size_bytes / unit_size) / 2);
 
+  /* If the read needs several packets, and the stub handles it, send
+     them without waiting for each reply.  Without acks, nothing else
+     needs to go over the link between them.  */
+  if (todo_units < len_units
+      && rs->noack_mode
+      && remote_memory_read_pipeline_depth > 1
+      && packet_support (PACKET_pipelined_memory_reads) == PACKET_ENABLE)
+    return remote_read_bytes_pipelined (memaddr, myaddr, len_units,
+					unit_size, todo_units,
+					xfered_len_units);
+
   /* Construct "m"<memaddr>","<len>".  */
   memaddr = remote_address_masked (memaddr);
   p = rs->buf.data ();
@@ -9202,6 +9554,242 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
 }
 
+/* Read LEN_UNITS addressable memory units at MEMADDR into MYADDR, with
+   up to remote_memory_read_pipeline_depth "m" packets of PACKET_UNITS
+   units each in flight, and the replies read in order.  The stub must
+   have reported the "pipelined-memory-reads" feature.  If one of the
+   packets fails or comes back short, the read stops there, but the
+   replies to the packets already sent are still consumed.
+
+   Parameters and return value are like remote_read_bytes_1's.  */
+
+target_xfer_status
+remote_target::remote_read_bytes_pipelined (CORE_ADDR memaddr,
+					    gdb_byte *myaddr,
+					    ULONGEST len_units,
+					    int unit_size,
+					    ULONGEST packet_units,
+					    ULONGEST *xfered_len_units)
+{
+  struct remote_state *rs = get_remote_state ();
+  ULONGEST n_packets = std::min ((ULONGEST) remote_memory_read_pipeline_depth,
+				 ((len_units + packet_units - 1)
+				  / packet_units));
+
+  for (ULONGEST i = 0; i < n_packets; i++)
+    {
+      ULONGEST offset = i * packet_units;
+      ULONGEST todo_units = std::min (packet_units, len_units - offset);
+
+      /* Construct "m"<memaddr>","<len>".  */
+      char *p = rs->buf.data ();
+      *p++ = 'm';
+      p += hexnumstr (p, (ULONGEST) remote_address_masked (memaddr + offset));
+      *p++ = ',';
+      p += hexnumstr (p, todo_units);
+      *p = '\0';
+      putpkt (rs->buf);
+    }
+
+  ULONGEST done_units = 0;
+  bool failed = false;
+  bool error_reply = false;
+  for (ULONGEST i = 0; i < n_packets; i++)
+    {
+      ULONGEST offset = i * packet_units;
+      ULONGEST todo_units = std::min (packet_units, len_units - offset);
+
+      getpkt (&rs->buf, 0);
+      if (failed)
+	continue;
+
+      if (rs->buf[0] == 'E'
+	  && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
+	  && rs->buf[3] == '\0')
+	{
+	  failed = true;
+	  error_reply = done_units == 0;
+	  continue;
+	}
+
+      /* Reply describes memory byte by byte, each byte encoded as two
+	 hex characters.  */
+      int decoded_bytes = hex2bin (rs->buf.data (),
+				   myaddr + done_units * unit_size,
+				   todo_units * unit_size);
+      done_units += decoded_bytes / unit_size;
+      if (decoded_bytes / unit_size != todo_units)
+	failed = true;
+    }
+
+  if (error_reply)
+    return TARGET_XFER_E_IO;
+
+  /* Return what we have.  Let higher layers handle partial reads.  */
+  *xfered_len_units = done_units;
+  return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
+}
+
+/* If the LEN bytes at MEMADDR start in the stack contents sent with
+   the last stop reply, copy as many of them as it has to MYADDR, set
+   *XFERED_LEN to their number and return true.  */
+
+bool
+remote_target::read_stack_snapshot (CORE_ADDR memaddr, gdb_byte *myaddr,
+				    ULONGEST len, ULONGEST *xfered_len)
+{
+  if (get_traceframe_number () != -1)
+    return false;
+
+  struct remote_state *rs = get_remote_state ();
+  return rs->stack_snapshot.read (inferior_ptid.pid (), memaddr, myaddr,
+				  len, xfered_len);
+}
+
+/* Read the memory ranges of REQUESTS with a single vReadMemory
+   packet, which the caller made sure fits, as does its reply.  Set
+   the XFERED_LEN field of each request to its length if it was read,
+   or to zero if not.  Return false if the stub doesn't support the
+   packet.  */
+
+bool
+remote_target::remote_read_memory_ranges
+  (gdb::array_view<memory_batch_request> requests)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  /* Construct "vReadMemory:"<addr>","<len>[";"<addr>","<len>]...  */
+  char *p = rs->buf.data ();
+  p += xsnprintf (p, rs->buf.size (), "vReadMemory:");
+  for (const memory_batch_request &req : requests)
+    {
+      if (&req != requests.begin ())
+	*p++ = ';';
+      p += hexnumstr (p, (ULONGEST) remote_address_masked (req.addr));
+      *p++ = ',';
+      p += hexnumstr (p, req.len);
+    }
+  *p = '\0';
+  putpkt (rs->buf);
+  getpkt (&rs->buf, 0);
+
+  switch (packet_ok (rs->buf, &remote_protocol_packets[PACKET_vReadMemory]))
+    {
+    case PACKET_UNKNOWN:
+      return false;
+    case PACKET_ERROR:
+      for (memory_batch_request &req : requests)
+	req.xfered_len = 0;
+      return true;
+    case PACKET_OK:
+      break;
+    }
+
+  /* The reply has one field per range, separated by ';': the
+     contents of the range in hex, or "Enn".  An error has an odd
+     number of characters, unlike the contents.  */
+  const char *reply = rs->buf.data ();
+  for (memory_batch_request &req : requests)
+    {
+      const char *end = strchrnul (reply, ';');
+
+      req.xfered_len = 0;
+      if ((ULONGEST) (end - reply) == 2 * req.len
+	  && (ULONGEST) hex2bin (reply, req.buf, req.len) == req.len)
+	req.xfered_len = req.len;
+
+      reply = end;
+      if (*reply == ';')
+	reply++;
+    }
+
+  return true;
+}
+
+/* Implement the xfer_memory_batch target method.  Read as many of the
+   ranges as fit in each vReadMemory packet and its reply, and the
+   ones the stub can't read through the usual path, so that the lower
+   targets can provide them.  */
+
+void
+remote_target::xfer_memory_batch
+  (gdb::array_view<memory_batch_request> requests)
+{
+  if (packet_support (PACKET_vReadMemory) == PACKET_DISABLE
+      || gdbarch_addressable_memory_unit_size (target_gdbarch ()) != 1
+      || !target_has_execution ()
+      || get_traceframe_number () != -1)
+    {
+      default_xfer_memory_batch (this, requests);
+      return;
+    }
+
+  set_remote_traceframe ();
+  set_general_thread (inferior_ptid);
+
+  /* The most characters a range takes in the packet: an address and
+     a length, and their separators.  */
+  const size_t range_size = 2 * (2 * sizeof (ULONGEST) + 1);
+  size_t max_request = get_remote_packet_size ();
+  size_t max_reply = get_memory_read_packet_size ();
+
+  while (!requests.empty ())
+    {
+      size_t count = 0;
+      size_t request_size = strlen ("vReadMemory:");
+      size_t reply_size = 0;
+
+      /* Don't ask the stub for what the last stop reply sent.  */
+      memory_batch_request &first = requests[0];
+      if (read_stack_snapshot (first.addr, first.buf, first.len,
+			       &first.xfered_len)
+	  && first.xfered_len == first.len)
+	{
+	  requests = requests.slice (1);
+	  continue;
+	}
+
+      for (; count < requests.size (); count++)
+	{
+	  ULONGEST xfered_len;
+
+	  if (count > 0
+	      && read_stack_snapshot (requests[count].addr,
+				      requests[count].buf,
+				      requests[count].len, &xfered_len)
+	      && xfered_len == requests[count].len)
+	    break;
+
+	  request_size += range_size;
+	  reply_size += 2 * requests[count].len + 1;
+	  if (request_size >= max_request || reply_size > max_reply)
+	    break;
+	}
+
+      /* A single range is read just as well by the usual path, which
+	 also handles ranges too large for one packet.  */
+      if (count < 2)
+	{
+	  default_xfer_memory_batch (this, requests.slice (0, 1));
+	  requests = requests.slice (1);
+	  continue;
+	}
+
+      gdb::array_view<memory_batch_request> batch = requests.slice (0, count);
+      if (!remote_read_memory_ranges (batch))
+	{
+	  default_xfer_memory_batch (this, requests);
+	  return;
+	}
+
+      for (memory_batch_request &req : batch)
+	if (req.xfered_len == 0)
+	  default_xfer_memory_batch (this, gdb::make_array_view (&req, 1));
+
+      requests = requests.slice (count);
+    }
+}
+
 /* Using the set of read-only target sections of remote, read live
    read-only memory.
 
@@ -9265,6 +9853,10 @@ remote_target::remote_read_bytes (CORE_ADDR memaddr,
   if (len == 0)
     return TARGET_XFER_EOF;
 
+  if (unit_size == 1
+      && read_stack_snapshot (memaddr, myaddr, len, xfered_len))
+    return TARGET_XFER_OK;
+
   if (get_traceframe_number () != -1)
     {
       std::vector<mem_range> available;
@@ -9786,11 +10378,11 @@ remote_target::read_frame (gdb::char_vector *buf_p)
 	       don't have any way to indicate a packet retransmission
 	       is necessary.  */
 	    if (rs->noack_mode)
-	      return bc;
+	      return inflate_frame (buf_p, bc);
 
 	    pktcsum = (fromhex (check_0) << 4) | fromhex (check_1);
 	    if (csum == pktcsum)
-	      return bc;
+	      return inflate_frame (buf_p, bc);
 
 	    remote_debug_printf
 	      ("Bad checksum, sentsum=0x%x, csum=0x%x, buf=%s",
@@ -9804,6 +10396,14 @@ remote_target::read_frame (gdb::char_vector *buf_p)
 	  {
 	    int repeat;
 
+	    /* Or, at the start of a reply, a compressed payload.  */
+	    if (bc == 0 && rs->compressed_replies)
+	      {
+		buf[bc++] = c;
+		csum += c;
+		continue;
+	      }
+
 	    csum += c;
 	    c = readchar (remote_timeout);
 	    csum += c;
@@ -9844,6 +10444,56 @@ remote_target::read_frame (gdb::char_vector *buf_p)
     }
 }
 
+/* If the BC bytes of the frame in *BUF_P are a compressed payload, a
+   '*' followed by zlib data escaped like binary data, replace them with
+   the decompressed payload.  Return the length of the payload, or -1
+   if it is corrupt.  */
+
+long
+remote_target::inflate_frame (gdb::char_vector *buf_p, long bc)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (!rs->compressed_replies || bc == 0 || (*buf_p)[0] != '*')
+    return bc;
+
+  gdb::byte_vector zdata (bc - 1);
+  int zlen = remote_unescape_input ((const gdb_byte *) buf_p->data () + 1,
+				    bc - 1, zdata.data (), bc - 1);
+
+  z_stream strm {};
+  if (inflateInit (&strm) != Z_OK)
+    return -1;
+  strm.next_in = zdata.data ();
+  strm.avail_in = zlen;
+
+  /* Grow the buffer as needed, keeping room for the terminating
+     NUL.  */
+  long len = 0;
+  int res;
+  do
+    {
+      if ((size_t) len + 1 >= buf_p->size ())
+	buf_p->resize (buf_p->size () * 2);
+      strm.next_out = (Bytef *) buf_p->data () + len;
+      strm.avail_out = buf_p->size () - 1 - len;
+      res = inflate (&strm, Z_NO_FLUSH);
+      len = buf_p->size () - 1 - strm.avail_out;
+    }
+  while (res == Z_OK);
+  inflateEnd (&strm);
+
+  if (res != Z_STREAM_END)
+    {
+      remote_debug_printf ("Corrupt compressed packet");
+      return -1;
+    }
+
+  (*buf_p)[len] = '\0';
+  remote_debug_printf ("Decompressed %ld bytes to %ld", bc, len);
+  return len;
+}
+
 /* Set this to the maximum number of seconds to wait instead of waiting forever
    in target_wait().  If this timer times out, then it generates an error and
    the command is aborted.  This replaces most of the need for timeouts in the
@@ -12185,8 +12835,6 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
 					   int *attachment_len)
 {
   struct remote_state *rs = get_remote_state ();
-  int ret, bytes_read;
-  const char *attachment_tmp;
 
   if (packet_support (which_packet) == PACKET_DISABLE)
     {
@@ -12195,6 +12843,23 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
     }
 
   putpkt_binary (rs->buf.data (), command_bytes);
+  return remote_hostio_get_reply (which_packet, remote_errno, attachment,
+				  attachment_len);
+}
+
+/* Read the response to an I/O packet sent to the target.  The answer
+   is in the global RS->BUF when we return.  Parameters and return
+   value are like remote_hostio_send_command's.  */
+
+int
+remote_target::remote_hostio_get_reply (int which_packet, int *remote_errno,
+					const char **attachment,
+					int *attachment_len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int ret, bytes_read;
+  const char *attachment_tmp;
+
   bytes_read = getpkt_sane (&rs->buf, 0);
 
   /* If it timed out, something is wrong.  Don't try to parse the
@@ -12243,12 +12908,21 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
   return ret;
 }
 
+/* Whether to keep a local copy of the files read from the target,
+   see "set remote file-cache".  */
+
+static bool remote_file_cache_enabled = false;
+
+/* The directory of the local file cache.  */
+
+static std::string remote_file_cache_directory;
+
 /* See declaration.h.  */
 
 void
 readahead_cache::invalidate ()
 {
-  this->fd = -1;
+  this->blocks.clear ();
 }
 
 /* See declaration.h.  */
@@ -12256,8 +12930,60 @@ readahead_cache::invalidate ()
 void
 readahead_cache::invalidate_fd (int fd)
 {
-  if (this->fd == fd)
-    this->fd = -1;
+  this->blocks.remove_if ([=] (const block &b)
+    {
+      return b.fd == fd;
+    });
+}
+
+/* See declaration.h.  */
+
+void
+readahead_cache::add (int fd, ULONGEST offset, gdb::byte_vector &&data)
+{
+  if (this->blocks.size () >= max_blocks)
+    this->blocks.pop_back ();
+
+  this->blocks.push_front ({ fd, offset, std::move (data) });
+}
+
+/* See declaration.h.  */
+
+unsigned int
+readahead_cache::sequential_blocks (int fd, ULONGEST offset) const
+{
+  unsigned int count = 0;
+
+  while (count < max_blocks)
+    {
+      auto it = std::find_if (this->blocks.begin (), this->blocks.end (),
+			      [=] (const block &b)
+	{
+	  return b.fd == fd && b.offset + b.data.size () == offset;
+	});
+
+      if (it == this->blocks.end ())
+	break;
+
+      offset = it->offset;
+      count++;
+    }
+
+  return count;
+}
+
+/* See declaration.h.  */
+
+ULONGEST
+readahead_cache::next_block_offset (int fd, ULONGEST offset) const
+{
+  ULONGEST next = ULONGEST_MAX;
+
+  for (const block &b : this->blocks)
+    if (b.fd == fd && b.offset > offset && b.offset < next)
+      next = b.offset;
+
+  return next;
 }
 
 /* Set the filesystem remote_hostio functions that take FILENAME
@@ -12348,8 +13074,284 @@ remote_target::fileio_open (struct inferior *inf, const char *filename,
 			    int flags, int mode, int warn_if_slow,
 			    int *remote_errno)
 {
-  return remote_hostio_open (inf, filename, flags, mode, warn_if_slow,
-			     remote_errno);
+  int fd = remote_hostio_open (inf, filename, flags, mode, warn_if_slow,
+			       remote_errno);
+
+  if (fd >= 0 && remote_file_cache_enabled && flags == FILEIO_O_RDONLY)
+    remote_file_cache_open (fd, filename);
+
+  return fd;
+}
+
+/* Read LEN bytes at OFFSET of the file open on the target as FD into
+   BUF, through the readahead cache.  Return true if all of them could
+   be read.  */
+
+bool
+remote_target::remote_file_read_fully (int fd, gdb_byte *buf, int len,
+				       ULONGEST offset)
+{
+  while (len > 0)
+    {
+      int remote_errno;
+      int bytes = remote_hostio_pread (fd, buf, len, offset, &remote_errno);
+      if (bytes <= 0)
+	return false;
+      buf += bytes;
+      offset += bytes;
+      len -= bytes;
+    }
+  return true;
+}
+
+/* Return the build ID of the ELF file open on the target as FD, in
+   hex, or the empty string if the file is not an ELF file or has no
+   build ID.  The note is found through the program headers, which
+   are at the start of the file, so this usually takes a single
+   vFile:pread, whose reply stays in the readahead cache for BFD.  */
+
+std::string
+remote_target::remote_file_build_id (int fd)
+{
+  union
+  {
+    Elf32_External_Ehdr e32;
+    Elf64_External_Ehdr e64;
+  } ehdr;
+  const unsigned char *ident = ehdr.e64.e_ident;
+  if (!remote_file_read_fully (fd, (gdb_byte *) &ehdr, sizeof (ehdr), 0)
+      || ident[EI_MAG0] != ELFMAG0 || ident[EI_MAG1] != ELFMAG1
+      || ident[EI_MAG2] != ELFMAG2 || ident[EI_MAG3] != ELFMAG3)
+    return {};
+
+  bool is_64 = ident[EI_CLASS] == ELFCLASS64;
+  if (!is_64 && ident[EI_CLASS] != ELFCLASS32)
+    return {};
+  bfd_endian byte_order = (ident[EI_DATA] == ELFDATA2MSB
+			   ? BFD_ENDIAN_BIG : BFD_ENDIAN_LITTLE);
+  auto field = [=] (const unsigned char *f, int len)
+    {
+      return extract_unsigned_integer (f, len, byte_order);
+    };
+#define ELF_FIELD(PTR, NAME) \
+  (is_64 \
+   ? field ((PTR ## 64)->NAME, sizeof ((PTR ## 64)->NAME)) \
+   : field ((PTR ## 32)->NAME, sizeof ((PTR ## 32)->NAME)))
+
+  const Elf64_External_Ehdr *ehdr64 = &ehdr.e64;
+  const Elf32_External_Ehdr *ehdr32 = &ehdr.e32;
+  ULONGEST phoff = ELF_FIELD (ehdr, e_phoff);
+  ULONGEST phentsize = ELF_FIELD (ehdr, e_phentsize);
+  ULONGEST phnum = ELF_FIELD (ehdr, e_phnum);
+  if (phentsize < (is_64
+		   ? sizeof (Elf64_External_Phdr)
+		   : sizeof (Elf32_External_Phdr))
+      || phnum == 0 || phnum > 256)
+    return {};
+
+  gdb::byte_vector phdrs (phentsize * phnum);
+  if (!remote_file_read_fully (fd, phdrs.data (), phdrs.size (), phoff))
+    return {};
+
+  for (ULONGEST i = 0; i < phnum; i++)
+    {
+      const gdb_byte *phdr = phdrs.data () + i * phentsize;
+      auto phdr64 = (const Elf64_External_Phdr *) phdr;
+      auto phdr32 = (const Elf32_External_Phdr *) phdr;
+      if (ELF_FIELD (phdr, p_type) != PT_NOTE)
+	continue;
+
+      ULONGEST offset = ELF_FIELD (phdr, p_offset);
+      ULONGEST filesz = ELF_FIELD (phdr, p_filesz);
+      ULONGEST align = ELF_FIELD (phdr, p_align) == 8 ? 8 : 4;
+      if (filesz > 0x10000)
+	continue;
+
+      gdb::byte_vector notes (filesz);
+      if (!remote_file_read_fully (fd, notes.data (), notes.size (), offset))
+	return {};
+
+      ULONGEST pos = 0;
+      while (pos + sizeof (Elf_External_Note) <= filesz)
+	{
+	  auto note = (const Elf_External_Note *) (notes.data () + pos);
+	  ULONGEST namesz = field (note->namesz, sizeof (note->namesz));
+	  ULONGEST descsz = field (note->descsz, sizeof (note->descsz));
+	  ULONGEST type = field (note->type, sizeof (note->type));
+	  ULONGEST desc = (pos + offsetof (Elf_External_Note, name)
+			   + align_up (namesz, align));
+	  if (desc > filesz || descsz > filesz - desc)
+	    break;
+
+	  if (type == NT_GNU_BUILD_ID && namesz == 4 && descsz > 0
+	      && memcmp (note->name, "GNU", 4) == 0)
+	    return bin2hex (notes.data () + desc, descsz);
+
+	  pos = desc + align_up (descsz, align);
+	}
+    }
+
+#undef ELF_FIELD
+
+  return {};
+}
+
+/* Return the name of the file in the local file cache holding a copy
+   of the target file FILENAME, whose status on the target is ST and
+   whose build ID is BUILD_ID, or the empty string if the file can't be
+   cached.  The copy is kept under the same path as on the target, with
+   the build ID appended, so that a copy is never used for a different
+   file, even one with the same name, size and modification time on
+   another target or in another sysroot.  */
+
+static std::string
+remote_file_cache_filename (const char *filename, const struct stat &st,
+			    const std::string &build_id)
+{
+  if (remote_file_cache_directory.empty ()
+      || filename[0] != '/'
+      || strstr (filename, "/../") != nullptr)
+    return {};
+
+  /* Only regular files with some contents can be cached.  Files in
+     /proc, for instance, have a size of zero.  */
+  if (!S_ISREG (st.st_mode) || st.st_size == 0)
+    return {};
+
+  /* Only files with a build ID can be identified.  */
+  if (build_id.empty ())
+    return {};
+
+  return string_printf ("%s%s@%s", remote_file_cache_directory.c_str (),
+			filename, build_id.c_str ());
+}
+
+/* Look up the file FILENAME, just opened on the target as FD, in the
+   local file cache.  If it is there, or can be added to it, read the
+   file from the local copy from now on.  The status and build ID of
+   the file on the target, which usually cost a vFile:fstat and a
+   vFile:pread, identify the local copy.
+
+   A file missing from the cache is copied whole here, before GDB
+   reads anything from it, so the first session costs the transfer of
+   the entire file, even if GDB would only have read part of it.  */
+
+void
+remote_target::remote_file_cache_open (int fd, const char *filename)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct stat st;
+  int remote_errno;
+
+  if (remote_hostio_fstat (fd, &st, &remote_errno) != 0)
+    return;
+
+  std::string cache_filename
+    = remote_file_cache_filename (filename, st,
+				  remote_file_build_id (fd));
+  if (cache_filename.empty ())
+    return;
+
+  scoped_fd local_fd = gdb_open_cloexec (cache_filename,
+					 O_RDONLY | O_BINARY, 0);
+  struct stat local_st;
+  if (local_fd.get () >= 0
+      && fstat (local_fd.get (), &local_st) == 0
+      && local_st.st_size == st.st_size)
+    {
+      remote_debug_printf ("file cache hit for %s", filename);
+      rs->cached_files[fd] = { std::move (local_fd), st };
+      return;
+    }
+
+  remote_debug_printf ("file cache miss for %s", filename);
+
+  if (!remote_file_cache_fetch (fd, st, cache_filename))
+    return;
+
+  local_fd = gdb_open_cloexec (cache_filename, O_RDONLY | O_BINARY, 0);
+  if (local_fd.get () >= 0)
+    rs->cached_files[fd] = { std::move (local_fd), st };
+}
+
+/* Copy the file open on the target as FD, whose status is ST, to
+   CACHE_FILENAME in the local file cache.  Return true on success.
+   Failing to write the cache is not an error, the file is just read
+   from the target as usual.  */
+
+bool
+remote_target::remote_file_cache_fetch (int fd, const struct stat &st,
+					const std::string &cache_filename)
+{
+  std::string dir = ldirname (cache_filename.c_str ());
+  if (!mkdir_recursive (dir.c_str ()))
+    {
+      warning (_("remote file cache: could not make cache directory %s: %s"),
+	       dir.c_str (), safe_strerror (errno));
+      return false;
+    }
+
+  /* Write the file under a temporary name and rename it into place
+     once complete, so that another GDB never reads a partial file.
+     Order matters here: the file is closed before it is unlinked on
+     failure.  */
+  gdb::char_vector temp_filename = make_temp_filename (cache_filename);
+  gdb::optional<gdb::unlinker> unlink_file;
+  scoped_fd temp_fd = gdb_mkostemp_cloexec (temp_filename.data (), O_BINARY);
+  if (temp_fd.get () < 0)
+    {
+      warning (_("remote file cache: could not create %s: %s"),
+	       temp_filename.data (), safe_strerror (errno));
+      return false;
+    }
+  unlink_file.emplace (temp_filename.data ());
+
+  gdb::byte_vector buf (get_remote_packet_size ());
+  ULONGEST offset = 0;
+  while (offset < (ULONGEST) st.st_size)
+    {
+      int remote_errno;
+      int bytes = remote_hostio_pread_vFile (fd, buf.data (), buf.size (),
+					     offset, &remote_errno);
+      if (bytes <= 0)
+	return false;
+
+      for (int done = 0; done < bytes; )
+	{
+	  int written = write (temp_fd.get (), buf.data () + done,
+			       bytes - done);
+	  if (written < 0)
+	    {
+	      warning (_("remote file cache: could not write %s: %s"),
+		       temp_filename.data (), safe_strerror (errno));
+	      return false;
+	    }
+	  done += written;
+	}
+
+      offset += bytes;
+    }
+
+  /* Make sure the file did not change on the target while it was
+     being copied.  */
+  struct stat new_st;
+  int remote_errno;
+  if (offset != (ULONGEST) st.st_size
+      || remote_hostio_fstat (fd, &new_st, &remote_errno) != 0
+      || new_st.st_size != st.st_size
+      || new_st.st_mtime != st.st_mtime)
+    return false;
+
+  if (::close (temp_fd.release ()) != 0
+      || rename (temp_filename.data (), cache_filename.c_str ()) != 0)
+    {
+      warning (_("remote file cache: could not write %s: %s"),
+	       cache_filename.c_str (), safe_strerror (errno));
+      return false;
+    }
+
+  unlink_file->keep ();
+  return true;
 }
 
 /* Implementation of to_fileio_pwrite.  */
@@ -12433,18 +13435,22 @@ int
 readahead_cache::pread (int fd, gdb_byte *read_buf, size_t len,
 			ULONGEST offset)
 {
-  if (this->fd == fd
-      && this->offset <= offset
-      && offset < this->offset + this->bufsize)
-    {
-      ULONGEST max = this->offset + this->bufsize;
+  for (auto it = this->blocks.begin (); it != this->blocks.end (); ++it)
+    if (it->fd == fd
+	&& it->offset <= offset
+	&& offset < it->offset + it->data.size ())
+      {
+	ULONGEST max = it->offset + it->data.size ();
 
-      if (offset + len > max)
-	len = max - offset;
+	if (offset + len > max)
+	  len = max - offset;
 
-      memcpy (read_buf, this->buf + offset - this->offset, len);
-      return len;
-    }
+	memcpy (read_buf, it->data.data () + offset - it->offset, len);
+
+	/* Make this the most recently used block.  */
+	this->blocks.splice (this->blocks.begin (), this->blocks, it);
+	return len;
+      }
 
   return 0;
 }
@@ -12459,6 +13465,29 @@ remote_target::remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
   struct remote_state *rs = get_remote_state ();
   readahead_cache *cache = &rs->readahead_cache;
 
+  auto it = rs->cached_files.find (fd);
+  if (it != rs->cached_files.end ())
+    {
+      int local_fd = it->second.fd.get ();
+
+#ifdef HAVE_PREAD
+      ret = pread (local_fd, read_buf, len, offset);
+#else
+      ret = -1;
+#endif
+      if (ret == -1)
+	{
+	  ret = lseek (local_fd, offset, SEEK_SET);
+	  if (ret != -1)
+	    ret = read (local_fd, read_buf, len);
+	}
+
+      if (ret == -1)
+	*remote_errno = host_to_fileio_error (errno);
+
+      return ret;
+    }
+
   ret = cache->pread (fd, read_buf, len, offset);
   if (ret > 0)
     {
@@ -12474,21 +13503,136 @@ remote_target::remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
   remote_debug_printf ("readahead cache miss %s",
 		       pulongest (cache->miss_count));
 
-  cache->fd = fd;
-  cache->offset = offset;
-  cache->bufsize = get_remote_packet_size ();
-  cache->buf = (gdb_byte *) xrealloc (cache->buf, cache->bufsize);
+  /* If the file is being read sequentially, and the stub handles it,
+     also read the blocks that follow, without waiting for each
+     reply.  Without acks, nothing else needs to go over the link
+     between them.  Read one more block than the sequential run
+     already read, so that long runs quickly reach the maximum
+     pipeline depth, while the occasional read that straddles two
+     blocks does not fetch much more than it needs.  */
+  unsigned int n_blocks = 0;
+  if (rs->noack_mode
+      && remote_file_read_pipeline_depth > 1
+      && packet_support (PACKET_pipelined_file_reads) == PACKET_ENABLE)
+    n_blocks = std::min (cache->sequential_blocks (fd, offset) + 1,
+			 remote_file_read_pipeline_depth);
+
+  if (n_blocks > 1)
+    ret = remote_hostio_pread_pipelined (fd, offset, n_blocks,
+					 remote_errno);
+  else
+    {
+      ULONGEST next = cache->next_block_offset (fd, offset);
+      gdb::byte_vector data (std::min ((ULONGEST) get_remote_packet_size (),
+				       next - offset));
+
+      ret = remote_hostio_pread_vFile (fd, data.data (), data.size (),
+				       offset, remote_errno);
+      if (ret > 0)
+	{
+	  data.resize (ret);
+	  cache->add (fd, offset, std::move (data));
+	}
+    }
 
-  ret = remote_hostio_pread_vFile (cache->fd, cache->buf, cache->bufsize,
-				   cache->offset, remote_errno);
   if (ret <= 0)
+    return ret;
+
+  return cache->pread (fd, read_buf, len, offset);
+}
+
+/* Read N_BLOCKS blocks of the file FD, starting at OFFSET, into the
+   readahead cache, with all the vFile:pread packets sent before the
+   replies are read, in order.  The stub must have reported the
+   "pipelined-file-reads" feature.  The blocks after a failed or short
+   read are still cached, since each packet gives its own offset.  No
+   block already in the cache is read again.
+
+   Return the result of reading the first block, like
+   remote_hostio_pread_vFile.  */
+
+int
+remote_target::remote_hostio_pread_pipelined (int fd, ULONGEST offset,
+					      unsigned int n_blocks,
+					      int *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  /* Ask for a bit less than fits in a packet, so that the escaping of
+     the data in the replies, or a stub with a smaller buffer, does
+     not make them short and the blocks follow each other without
+     gaps.  */
+  int block_size = get_remote_packet_size () / 8 * 7;
+  ULONGEST next = rs->readahead_cache.next_block_offset (fd, offset);
+
+  /* Keep the first block in the cache until the caller reads it.  */
+  n_blocks = std::min (n_blocks,
+		       (unsigned int) readahead_cache::max_blocks / 2);
+
+  unsigned int n_packets = 0;
+  for (; n_packets < n_blocks; n_packets++)
     {
-      cache->invalidate_fd (fd);
-      return ret;
+      ULONGEST block_offset = offset + n_packets * block_size;
+      if (block_offset >= next)
+	break;
+
+      char *p = rs->buf.data ();
+      int left = get_remote_packet_size ();
+
+      remote_buffer_add_string (&p, &left, "vFile:pread:");
+
+      remote_buffer_add_int (&p, &left, fd);
+      remote_buffer_add_string (&p, &left, ",");
+
+      remote_buffer_add_int (&p, &left,
+			     std::min ((ULONGEST) block_size,
+				       next - block_offset));
+      remote_buffer_add_string (&p, &left, ",");
+
+      remote_buffer_add_int (&p, &left, block_offset);
+
+      putpkt_binary (rs->buf.data (), p - rs->buf.data ());
     }
 
-  cache->bufsize = ret;
-  return cache->pread (fd, read_buf, len, offset);
+  int ret = -1;
+  int bad_bytes = -1, bad_read_len = -1;
+  for (unsigned int i = 0; i < n_packets; i++)
+    {
+      const char *attachment;
+      int attachment_len;
+      int packet_errno;
+      int bytes = remote_hostio_get_reply (PACKET_vFile_pread, &packet_errno,
+					   &attachment, &attachment_len);
+
+      if (i == 0)
+	{
+	  ret = bytes;
+	  *remote_errno = packet_errno;
+	}
+
+      if (bytes <= 0 || bad_bytes != -1)
+	continue;
+
+      gdb::byte_vector data (bytes);
+      int read_len = remote_unescape_input ((const gdb_byte *) attachment,
+					    attachment_len, data.data (),
+					    bytes);
+      if (read_len != bytes)
+	{
+	  /* Report this once all the replies have been read, to keep
+	     the stream in sync.  */
+	  bad_bytes = bytes;
+	  bad_read_len = read_len;
+	  continue;
+	}
+
+      rs->readahead_cache.add (fd, offset + i * block_size, std::move (data));
+    }
+
+  if (bad_bytes != -1)
+    error (_("Read returned %d, but %d bytes."), bad_bytes, bad_read_len);
+
+  return ret;
 }
 
 int
@@ -12508,6 +13652,7 @@ remote_target::remote_hostio_close (int fd, int *remote_errno)
   int left = get_remote_packet_size () - 1;
 
   rs->readahead_cache.invalidate_fd (fd);
+  rs->cached_files.erase (fd);
 
   remote_buffer_add_string (&p, &left, "vFile:close:");
 
@@ -12590,10 +13735,13 @@ remote_target::fileio_readlink (struct inferior *inf, const char *filename,
   return ret;
 }
 
-/* Implementation of to_fileio_fstat.  */
+/* Get the status of the file open on the target as FD with
+   vFile:fstat.  Return 0 on success, or -1 if an error occurs (and
+   set *REMOTE_ERRNO).  */
 
 int
-remote_target::fileio_fstat (int fd, struct stat *st, int *remote_errno)
+remote_target::remote_hostio_fstat (int fd, struct stat *st,
+				    int *remote_errno)
 {
   struct remote_state *rs = get_remote_state ();
   char *p = rs->buf.data ();
@@ -12610,6 +13758,41 @@ remote_target::fileio_fstat (int fd, struct stat *st, int *remote_errno)
   ret = remote_hostio_send_command (p - rs->buf.data (), PACKET_vFile_fstat,
 				    remote_errno, &attachment,
 				    &attachment_len);
+  if (ret < 0)
+    return ret;
+
+  read_len = remote_unescape_input ((gdb_byte *) attachment, attachment_len,
+				    (gdb_byte *) &fst, sizeof (fst));
+
+  if (read_len != ret)
+    error (_("vFile:fstat returned %d, but %d bytes."), ret, read_len);
+
+  if (read_len != sizeof (fst))
+    error (_("vFile:fstat returned %d bytes, but expecting %d."),
+	   read_len, (int) sizeof (fst));
+
+  remote_fileio_to_host_stat (&fst, st);
+
+  return 0;
+}
+
+/* Implementation of to_fileio_fstat.  */
+
+int
+remote_target::fileio_fstat (int fd, struct stat *st, int *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  /* The status of a file read from the local file cache was fetched
+     when it was opened.  */
+  auto it = rs->cached_files.find (fd);
+  if (it != rs->cached_files.end ())
+    {
+      *st = it->second.st;
+      return 0;
+    }
+
+  int ret = remote_hostio_fstat (fd, st, remote_errno);
   if (ret < 0)
     {
       if (*remote_errno != FILEIO_ENOSYS)
@@ -12633,18 +13816,6 @@ remote_target::fileio_fstat (int fd, struct stat *st, int *remote_errno)
       return 0;
     }
 
-  read_len = remote_unescape_input ((gdb_byte *) attachment, attachment_len,
-				    (gdb_byte *) &fst, sizeof (fst));
-
-  if (read_len != ret)
-    error (_("vFile:fstat returned %d, but %d bytes."), ret, read_len);
-
-  if (read_len != sizeof (fst))
-    error (_("vFile:fstat returned %d bytes, but expecting %d."),
-	   read_len, (int) sizeof (fst));
-
-  remote_fileio_to_host_stat (&fst, st);
-
   return 0;
 }
 
@@ -15015,6 +16186,82 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("memory-read-pipeline-depth", no_class,
+			     &remote_memory_read_pipeline_depth, _("\
+Set the maximum number of memory-read packets in flight."), _("\
+Show the maximum number of memory-read packets in flight."), _("\
+When a memory read needs several packets, and the remote stub supports\n\
+it, GDB sends up to this many packets before waiting for their replies,\n\
+so that the read isn't bound by the round-trip time of the connection.\n\
+This needs the no-acknowledgment mode.  A value of 0 or 1 disables it.\n\
+The maximum is 64."),
+			     set_read_pipeline_depth, NULL,
+			     &remote_set_cmdlist,
+			     &remote_show_cmdlist);
+
+  add_setshow_zuinteger_cmd ("file-read-pipeline-depth", no_class,
+			     &remote_file_read_pipeline_depth, _("\
+Set the maximum number of vFile:pread packets in flight."), _("\
+Show the maximum number of vFile:pread packets in flight."), _("\
+When a file is read sequentially from the target, and the remote stub\n\
+supports it, GDB reads this many blocks ahead into the readahead cache,\n\
+sending the packets before waiting for their replies.  This needs the\n\
+no-acknowledgment mode.  A value of 0 or 1 disables it.  The maximum\n\
+is 64."),
+			     set_read_pipeline_depth, NULL,
+			     &remote_set_cmdlist,
+			     &remote_show_cmdlist);
+
+  add_setshow_string_noescape_cmd ("expedited-registers", no_class,
+				   &remote_expedited_registers, _("\
+Set the registers to ask the remote stub to send in stop replies."), _("\
+Show the registers to ask the remote stub to send in stop replies."), _("\
+The argument is a list of register names, separated by spaces.  When the\n\
+remote stub supports it, it sends these registers along with the ones it\n\
+sends anyway when the program stops, so that GDB doesn't need to read\n\
+them with separate packets."),
+				   set_remote_expedite, NULL,
+				   &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_zuinteger_cmd ("expedited-stack-size", no_class,
+			     &remote_expedited_stack_size, _("\
+Set the number of stack bytes the remote stub sends in stop replies."),
+			     _("\
+Show the number of stack bytes the remote stub sends in stop replies."),
+			     _("\
+When the remote stub supports it, it sends this many bytes of memory from\n\
+the stack pointer when the program stops, and GDB reads the memory there\n\
+without asking the stub again, until the program is resumed.  This is\n\
+only done in all-stop mode.  A value of 0 disables it."),
+			     set_remote_expedite, NULL,
+			     &remote_set_cmdlist,
+			     &remote_show_cmdlist);
+
+  add_setshow_boolean_cmd ("file-cache", no_class,
+			   &remote_file_cache_enabled, _("\
+Set whether to keep a local copy of the files read from the target."), _("\
+Show whether to keep a local copy of the files read from the target."), _("\
+When on, a file that GDB reads from the target, for instance a shared\n\
+library when the sysroot is \"target:\", is copied to the directory set\n\
+with \"set remote file-cache-directory\".  The next time the file is\n\
+read, it is read from the local copy if the file on the target has the\n\
+same build ID.  Only files with a build ID are copied, and a file is\n\
+copied whole when it is first opened."),
+			   NULL, NULL,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
+  std::string cache_dir = get_standard_cache_dir ();
+  if (!cache_dir.empty ())
+    remote_file_cache_directory = cache_dir + "/remote-files";
+
+  add_setshow_filename_cmd ("file-cache-directory", no_class,
+			    &remote_file_cache_directory, _("\
+Set the directory of the local copies of the files read from the target."),
+			    _("\
+Show the directory of the local copies of the files read from the target."),
+			    NULL, NULL, NULL,
+			    &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zuinteger_unlimited_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -15302,6 +16549,24 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_memory_tagging_feature],
 			 "memory-tagging-feature", "memory-tagging-feature", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_pipelined_memory_reads],
+			 "pipelined-memory-reads", "pipelined-memory-reads", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_pipelined_file_reads],
+			 "pipelined-file-reads", "pipelined-file-reads", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_vReadMemory],
+			 "vReadMemory", "read-memory-ranges", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_QCompressReplies],
+			 "QCompressReplies", "compress-replies", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_QExpediteRegisters],
+			 "QExpediteRegisters", "expedite-registers", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_QExpediteStack],
+			 "QExpediteStack", "expedite-stack", 0);
+
   /* Assert that we've registered "set remote foo-packet" commands
      for all packet configs.  */
   {
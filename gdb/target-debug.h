@@ -198,6 +198,18 @@ target_debug_print_target_wait_flags (target_wait_flags options)
   gdb_puts (str.c_str (), gdb_stdlog);
 }
 
+static void
+target_debug_print_memory_batch
+  (gdb::array_view<memory_batch_request> requests)
+{
+  gdb_puts ("{", gdb_stdlog);
+
+  for (const memory_batch_request &req : requests)
+    gdb_printf (gdb_stdlog, " %s,%s", core_addr_to_string_nz (req.addr),
+		pulongest (req.len));
+  gdb_puts (" }", gdb_stdlog);
+}
+
 static void
 target_debug_print_signals (gdb::array_view<const unsigned char> sigs)
 {
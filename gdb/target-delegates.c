@@ -113,6 +113,7 @@ struct dummy_target : public target_ops
   void goto_bookmark (const gdb_byte *arg0, int arg1) override;
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
+  void xfer_memory_batch (gdb::array_view<memory_batch_request> arg0) override;
   ULONGEST get_memory_xfer_limit () override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
@@ -287,6 +288,7 @@ struct debug_target : public target_ops
   void goto_bookmark (const gdb_byte *arg0, int arg1) override;
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
+  void xfer_memory_batch (gdb::array_view<memory_batch_request> arg0) override;
   ULONGEST get_memory_xfer_limit () override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
@@ -2474,6 +2476,28 @@ debug_target::xfer_partial (enum target_object arg0, const char *arg1, gdb_byte
   return result;
 }
 
+void
+target_ops::xfer_memory_batch (gdb::array_view<memory_batch_request> arg0)
+{
+  this->beneath ()->xfer_memory_batch (arg0);
+}
+
+void
+dummy_target::xfer_memory_batch (gdb::array_view<memory_batch_request> arg0)
+{
+  default_xfer_memory_batch (this, arg0);
+}
+
+void
+debug_target::xfer_memory_batch (gdb::array_view<memory_batch_request> arg0)
+{
+  gdb_printf (gdb_stdlog, "-> %s->xfer_memory_batch (...)\n", this->beneath ()->shortname ());
+  this->beneath ()->xfer_memory_batch (arg0);
+  gdb_printf (gdb_stdlog, "<- %s->xfer_memory_batch (", this->beneath ()->shortname ());
+  target_debug_print_memory_batch (arg0);
+  gdb_puts (")\n", gdb_stdlog);
+}
+
 ULONGEST
 target_ops::get_memory_xfer_limit ()
 {
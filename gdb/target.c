@@ -1856,6 +1856,33 @@ target_read_raw_memory (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
     return -1;
 }
 
+/* See target.h.  */
+
+void
+target_read_raw_memory_batch (gdb::array_view<memory_batch_request> requests)
+{
+  if (requests.empty ())
+    return;
+
+  current_inferior ()->top_target ()->xfer_memory_batch (requests);
+}
+
+/* See target.h.  */
+
+void
+default_xfer_memory_batch (struct target_ops *self,
+			   gdb::array_view<memory_batch_request> requests)
+{
+  target_ops *top = current_inferior ()->top_target ();
+
+  for (memory_batch_request &req : requests)
+    {
+      LONGEST res = target_read (top, TARGET_OBJECT_RAW_MEMORY, NULL,
+				 req.buf, req.addr, req.len);
+      req.xfered_len = res < 0 ? 0 : res;
+    }
+}
+
 /* Like target_read_memory, but specify explicitly that this is a read from
    the target's stack.  This may trigger different cache behavior.  */
 
@@ -296,6 +296,20 @@ struct memory_read_result
 extern std::vector<memory_read_result> read_memory_robust
     (struct target_ops *ops, const ULONGEST offset, const LONGEST len);
 
+/* One range of memory to read with target_read_raw_memory_batch.  */
+
+struct memory_batch_request
+{
+  /* The address of the first byte to read.  */
+  CORE_ADDR addr;
+  /* The buffer to read into.  It is LEN bytes long.  */
+  gdb_byte *buf;
+  /* The number of bytes to read.  */
+  ULONGEST len;
+  /* Set to the number of bytes actually read, starting at ADDR.  */
+  ULONGEST xfered_len;
+};
+
 /* Request that OPS transfer up to LEN addressable units from BUF to the
    target's OBJECT.  When writing to a memory object, the addressable unit
    size is architecture dependent and can be found using
@@ -799,6 +813,15 @@ struct target_ops
 						  ULONGEST *xfered_len)
       TARGET_DEFAULT_RETURN (TARGET_XFER_E_IO);
 
+    /* Read several ranges of raw memory, as if each request of
+       REQUESTS was read with target_read_raw_memory, and set their
+       XFERED_LEN.  Targets that can read scattered ranges more
+       cheaply than one at a time, e.g. with a single system call,
+       should implement this.  The default reads them one at a
+       time.  */
+    virtual void xfer_memory_batch (gdb::array_view<memory_batch_request> TARGET_DEBUG_PRINTER (target_debug_print_memory_batch))
+      TARGET_DEFAULT_FUNC (default_xfer_memory_batch);
+
     /* Return the limit on the size of any single memory transfer
        for the target.  */
 
@@ -1582,6 +1605,22 @@ extern int target_read_raw_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
 
 extern int target_read_stack (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
+/* Read all the ranges of raw memory described by REQUESTS, bypassing
+   the dcache and breakpoint shadowing like target_read_raw_memory,
+   and set the XFERED_LEN of each request to the number of bytes read
+   for it.  The target may read them with fewer transfers than one per
+   request.  */
+
+extern void target_read_raw_memory_batch
+  (gdb::array_view<memory_batch_request> requests);
+
+/* The default implementation of the xfer_memory_batch target method,
+   which reads each of REQUESTS through the whole target stack, one at
+   a time.  SELF is unused.  */
+
+extern void default_xfer_memory_batch
+  (struct target_ops *self, gdb::array_view<memory_batch_request> requests);
+
 extern int target_read_code (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
 /* For target_write_memory see target/target.h.  */
@@ -0,0 +1,35 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2022 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+
+void __attribute__((noinline))
+breakpt (void)
+{
+}
+
+int
+main ()
+{
+  /* Make sure the stack above the breakpoint's frame is mapped, and
+     holds known contents.  */
+  char buf[4096];
+
+  memset (buf, 0x5a, sizeof buf);
+  breakpt ();
+  return buf[0] != 0x5a;
+}
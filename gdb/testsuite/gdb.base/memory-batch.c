@@ -0,0 +1,89 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2022 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+
+#define PG_COUNT 4
+
+size_t pg_size;
+unsigned char *mapped_buf;
+unsigned char *expected_buf;
+
+void
+breakpt (void)
+{
+  /* Nothing. */
+}
+
+int
+main (void)
+{
+  size_t i;
+
+  /* Map 4 contiguous pages, fill them, then make the second one
+     inaccessible to the program and unmap the last one:
+
+      .---.---.---.---.
+      | M | P | M | U |
+      '---'---'---'---'
+
+     A PROT_NONE page can't be read with process_vm_readv, but the
+     debugger can still read it through /proc/PID/mem.  An unmapped
+     page can't be read at all.  EXPECTED_BUF holds a copy of the first
+     three pages, to compare with what the debugger reads.  */
+
+  pg_size = getpagesize ();
+
+  mapped_buf = mmap (0, PG_COUNT * pg_size, PROT_READ|PROT_WRITE,
+		     MAP_ANONYMOUS|MAP_PRIVATE, -1, 0);
+  if (mapped_buf == MAP_FAILED)
+    {
+      perror ("mmap");
+      return EXIT_FAILURE;
+    }
+
+  expected_buf = malloc (3 * pg_size);
+  if (expected_buf == NULL)
+    {
+      perror ("malloc");
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < 3 * pg_size; i++)
+    mapped_buf[i] = i * 7 + i / 251;
+  memcpy (expected_buf, mapped_buf, 3 * pg_size);
+
+  if (mprotect (mapped_buf + pg_size, pg_size, PROT_NONE) == -1)
+    {
+      perror ("mprotect");
+      return EXIT_FAILURE;
+    }
+
+  if (munmap (mapped_buf + 3 * pg_size, pg_size) == -1)
+    {
+      perror ("munmap");
+      return EXIT_FAILURE;
+    }
+
+  breakpt ();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2022 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define BUF_SIZE 4096
+
+/* Read by the debugger with a single memory read packet.  */
+unsigned char buf[BUF_SIZE];
+
+/* Return the Adler-32 checksum of the hex encoding of the N bytes at
+   P, as sent by GDBserver in reply to a memory read.  */
+
+static unsigned long
+adler32_hex (const unsigned char *p, int n)
+{
+  unsigned long s1 = 1, s2 = 0;
+  int i, j;
+
+  for (i = 0; i < n; i++)
+    for (j = 0; j < 2; j++)
+      {
+	int nib = j == 0 ? p[i] >> 4 : p[i] & 0xf;
+
+	s1 = (s1 + "0123456789abcdef"[nib]) % 65521;
+	s2 = (s2 + s1) % 65521;
+      }
+
+  return (s2 << 16) | s1;
+}
+
+/* Return non-zero if one of the bytes of VALUE must be escaped in a
+   remote protocol packet.  */
+
+static int
+needs_escape (unsigned long value)
+{
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      int c = (value >> (8 * i)) & 0xff;
+
+      if (c == '$' || c == '#' || c == '}' || c == '*')
+	return 1;
+    }
+  return 0;
+}
+
+void
+breakpt (void)
+{
+  /* Nothing. */
+}
+
+int
+main (void)
+{
+  unsigned int seed = 1;
+  int i;
+
+  /* Fill the buffer with bytes from a small set, so that the reply
+     compresses well, but not so well that the compressed data is
+     short or regular.  */
+  for (i = 0; i < BUF_SIZE; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      buf[i] = "abcd"[(seed >> 16) % 4];
+    }
+
+  /* The zlib stream ends with the Adler-32 checksum of the
+     uncompressed data.  Change the last byte until one of the
+     checksum's bytes must be escaped, so that the compressed reply
+     contains at least one escaped byte whatever the compressor
+     produces.  */
+  for (i = 0; i < 256; i++)
+    {
+      buf[BUF_SIZE - 1] = i;
+      if (needs_escape (adler32_hex (buf, BUF_SIZE)))
+	break;
+    }
+
+  breakpt ();
+
+  return 0;
+}
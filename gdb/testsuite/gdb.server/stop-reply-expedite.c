@@ -0,0 +1,42 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2022 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+int global_var;
+
+void
+breakpt (volatile int *p)
+{
+  /* Nothing. */
+}
+
+int
+main (void)
+{
+  volatile int local[8];
+  int n, i;
+
+  /* Change the stack between the stops, so that stale stack contents
+     can be told apart.  */
+  for (n = 0; n < 3; n++)
+    {
+      for (i = 0; i < 8; i++)
+	local[i] = n * 100 + i + 1;
+      breakpt (local);
+    }
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/* Self tests for the bcache
+
+   Copyright (C) 2022 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "defs.h"
+#include "gdbsupport/selftest.h"
+#include "gdbsupport/parallel-for.h"
+#include "bcache.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace selftests {
+namespace bcache {
+
+/* The number of distinct strings inserted by the tests.  */
+#define NUMBER 2000
+
+/* Return the Nth test string.  */
+
+static std::string
+test_string (int n)
+{
+  return "string-" + std::to_string (n);
+}
+
+/* Check that CACHE returns the same copy for equal strings.  */
+
+template<typename Cache>
+static void
+test_dedup (Cache &cache)
+{
+  std::vector<const char *> copies (NUMBER);
+
+  for (int i = 0; i < NUMBER; ++i)
+    {
+      std::string str = test_string (i);
+      bool added;
+      copies[i] = (const char *) cache.insert (str.c_str (), str.size () + 1,
+					       &added);
+      SELF_CHECK (added);
+      SELF_CHECK (str == copies[i]);
+    }
+
+  for (int i = 0; i < NUMBER; ++i)
+    {
+      std::string str = test_string (i);
+      bool added;
+      const char *copy
+	= (const char *) cache.insert (str.c_str (), str.size () + 1, &added);
+      SELF_CHECK (!added);
+      SELF_CHECK (copy == copies[i]);
+    }
+}
+
+static void
+test_bcache ()
+{
+  gdb::bcache cache;
+  test_dedup (cache);
+
+  gdb::concurrent_bcache concurrent_cache;
+  test_dedup (concurrent_cache);
+}
+
+#if CXX_STD_THREAD
+
+/* Insert every string several times, from the worker threads, and
+   check that each string got added exactly once and that all the
+   threads got the same copy.  */
+
+static void
+test_concurrent_bcache ()
+{
+  gdb::concurrent_bcache cache;
+  const int n_copies = 4;
+  std::vector<std::atomic<const char *>> copies (NUMBER);
+  std::atomic<int> n_added (0);
+  /* SELF_CHECK must not be used in the worker threads, so count the
+     mismatches and check them afterwards.  */
+  std::atomic<int> n_mismatches (0);
+
+  for (auto &copy : copies)
+    copy = nullptr;
+
+  gdb::parallel_for_each (0, NUMBER * n_copies,
+			  [&] (int start, int end)
+			  {
+			    for (int i = start; i < end; ++i)
+			      {
+				int n = i % NUMBER;
+				std::string str = test_string (n);
+				bool added;
+				const char *copy
+				  = ((const char *)
+				     cache.insert (str.c_str (),
+						   str.size () + 1,
+						   &added));
+				if (added)
+				  ++n_added;
+
+				const char *expected = nullptr;
+				if (!copies[n].compare_exchange_strong (expected,
+									copy)
+				    && expected != copy)
+				  ++n_mismatches;
+			      }
+			  });
+
+  SELF_CHECK (n_mismatches == 0);
+  SELF_CHECK (n_added == NUMBER);
+  for (int i = 0; i < NUMBER; ++i)
+    SELF_CHECK (test_string (i) == copies[i].load ());
+}
+
+#endif /* CXX_STD_THREAD */
+
+#undef NUMBER
+
+}
+}
+
+void _initialize_bcache_selftests ();
+void
+_initialize_bcache_selftests ()
+{
+  selftests::register_test ("bcache", selftests::bcache::test_bcache);
+#if CXX_STD_THREAD
+  selftests::register_test ("concurrent_bcache",
+			    selftests::bcache::test_concurrent_bcache);
+#endif /* CXX_STD_THREAD */
+}
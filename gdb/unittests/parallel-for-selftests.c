@@ -60,6 +60,36 @@ test (int n_threads)
 
   SELF_CHECK (counter == NUMBER);
 
+  /* Give the elements very uneven sizes, and check that every element
+     is still processed exactly once.  */
+  std::vector<std::atomic<int>> seen (NUMBER);
+  for (auto &item : seen)
+    item = 0;
+  auto size_fn = [] (int elt) -> size_t
+    {
+      return elt % 100 == 0 ? 1000 : 1;
+    };
+  gdb::function_view<size_t (int)> task_size = size_fn;
+  counter = 0;
+  /* A failing SELF_CHECK in a worker thread would not be reported, so
+     count the empty subranges and check the count afterwards.  */
+  std::atomic<int> empty_ranges (0);
+  gdb::parallel_for_each (0, NUMBER,
+			  [&] (int start, int end)
+			  {
+			    if (start >= end)
+			      ++empty_ranges;
+			    counter += end - start;
+			    for (int i = start; i < end; ++i)
+			      ++seen[i];
+			  },
+			  task_size);
+
+  SELF_CHECK (empty_ranges == 0);
+  SELF_CHECK (counter == NUMBER);
+  for (auto &item : seen)
+    SELF_CHECK (item == 1);
+
 #undef NUMBER
 }
 
@@ -21,6 +21,9 @@ m4_include(../gdbsupport/common.m4)
 dnl For libiberty_INIT.
 m4_include(../gdb/libiberty.m4)
 
+dnl For AM_ZLIB.
+m4_include(../config/zlib.m4)
+
 dnl For GDB_AC_PTRACE.
 m4_include(../gdbsupport/ptrace.m4)
 
@@ -345,9 +345,14 @@ static void
 handle_pread (char *own_buf, int *new_packet_len)
 {
   int fd, ret, len, offset, bytes_sent;
-  char *p, *data;
+  char *p;
   static int max_reply_size = -1;
 
+  /* GDB may send several requests back to back when it reads a file
+     ahead (see the "pipelined-file-reads" feature), so keep the
+     buffer rather than allocating one for each of them.  */
+  static char *data;
+
   p = own_buf + strlen ("vFile:pread:");
 
   if (require_int (&p, &fd)
@@ -373,7 +378,8 @@ handle_pread (char *own_buf, int *new_packet_len)
   if (len > max_reply_size)
     len = max_reply_size;
 
-  data = (char *) xmalloc (len);
+  if (data == NULL)
+    data = (char *) xmalloc (max_reply_size);
 #ifdef HAVE_PREAD
   ret = pread (fd, data, len, offset);
 #else
@@ -390,7 +396,6 @@ handle_pread (char *own_buf, int *new_packet_len)
   if (ret == -1)
     {
       hostio_error (own_buf);
-      free (data);
       return;
     }
 
@@ -404,8 +409,6 @@ handle_pread (char *own_buf, int *new_packet_len)
   if (bytes_sent < ret)
     bytes_sent = hostio_reply_with_data (own_buf, data, bytes_sent,
 					 new_packet_len);
-
-  free (data);
 }
 
 static void
@@ -5398,6 +5398,78 @@ linux_process_target::read_memory (CORE_ADDR memaddr,
   return ret;
 }
 
+/* Whether process_vm_readv can be used.  Cleared the first time the
+   system call is found not to work.  */
+
+static bool use_process_vm_readv = true;
+
+/* The number of ranges to pass to one process_vm_readv call.  This is
+   well below IOV_MAX on any Linux system.  */
+
+#define READ_MEMORY_BATCH_SIZE 64
+
+/* Read several memory ranges with one process_vm_readv system call
+   per READ_MEMORY_BATCH_SIZE ranges.  The kernel stops at the first
+   range that can't be read completely, so the ranges that were read
+   are those covered by the byte count returned.  */
+
+int
+linux_process_target::read_memory_batch
+  (gdb::array_view<memory_read_range> ranges)
+{
+#ifdef __NR_process_vm_readv
+  int pid = lwpid_of (current_thread);
+  size_t done = 0;
+
+  while (use_process_vm_readv && done < ranges.size ())
+    {
+      struct iovec local[READ_MEMORY_BATCH_SIZE];
+      struct iovec remote[READ_MEMORY_BATCH_SIZE];
+      size_t count = 0;
+
+      for (; (count < READ_MEMORY_BATCH_SIZE
+	      && done + count < ranges.size ()); count++)
+	{
+	  const memory_read_range &range = ranges[done + count];
+
+	  /* The address may not fit in a pointer, for instance with a
+	     32-bit GDBserver debugging a 64-bit program.  */
+	  if ((CORE_ADDR) (uintptr_t) range.addr != range.addr)
+	    break;
+
+	  local[count].iov_base = range.buf;
+	  local[count].iov_len = range.len;
+	  remote[count].iov_base = (void *) (uintptr_t) range.addr;
+	  remote[count].iov_len = range.len;
+	}
+      if (count == 0)
+	break;
+
+      long bytes = syscall (__NR_process_vm_readv, pid, local, count,
+			    remote, count, 0);
+      if (bytes < 0)
+	{
+	  if (errno == ENOSYS || errno == EPERM)
+	    use_process_vm_readv = false;
+	  break;
+	}
+
+      size_t left = bytes;
+      size_t i;
+      for (i = 0; i < count && left >= local[i].iov_len; i++)
+	left -= local[i].iov_len;
+      done += i;
+
+      if (i < count)
+	break;
+    }
+
+  return done;
+#else
+  return 0;
+#endif
+}
+
 /* Copy LEN bytes of data from debugger memory at MYADDR to inferior's
    memory at MEMADDR.  On failure (cannot write to the inferior)
    returns the value of errno.  Always succeeds if LEN is zero.  */
@@ -170,6 +170,8 @@ class linux_process_target : public process_stratum_target
   int read_memory (CORE_ADDR memaddr, unsigned char *myaddr,
 		   int len) override;
 
+  int read_memory_batch (gdb::array_view<memory_read_range> ranges) override;
+
   int write_memory (CORE_ADDR memaddr, const unsigned char *myaddr,
 		    int len) override;
 
@@ -29,7 +29,9 @@
 #include "gdbsupport/netstuff.h"
 #include "gdbsupport/filestuff.h"
 #include "gdbsupport/gdb-sigmask.h"
+#include "gdbsupport/byte-vector.h"
 #include <ctype.h>
+#include <zlib.h>
 #if HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
@@ -510,6 +512,48 @@ try_rle (char *buf, int remaining, unsigned char *csum, char **p)
   return n + 1;
 }
 
+/* Replies at least this long are compressed, if GDB asked for it with
+   the QCompressReplies packet.  Shorter ones gain little, if
+   anything.  */
+
+#define COMPRESS_REPLY_THRESHOLD 256
+
+/* Compress the CNT bytes of the reply at BUF with zlib, and store the
+   result at OUT: a '*', which tells GDB that the payload is
+   compressed, followed by the compressed data, escaped like binary
+   data.  Return the length of the result, or -1 if it would be longer
+   than MAXLEN bytes, in which case OUT is left alone.  */
+
+static int
+compress_reply (const char *buf, int cnt, char *out, int maxlen)
+{
+  static gdb::byte_vector zbuf;
+  static gdb::byte_vector escaped;
+  uLongf zlen = compressBound (cnt);
+
+  if (maxlen < 1)
+    return -1;
+
+  zbuf.resize (zlen);
+  if (compress2 (zbuf.data (), &zlen, (const Bytef *) buf, cnt,
+		 Z_BEST_SPEED) != Z_OK)
+    return -1;
+
+  /* Escape into a separate buffer, as OUT may hold the uncompressed
+     reply, which is sent instead if the compressed one is too
+     long.  */
+  int consumed;
+  escaped.resize (maxlen - 1);
+  int len = remote_escape_output (zbuf.data (), zlen, 1, escaped.data (),
+				  &consumed, maxlen - 1);
+  if ((uLongf) consumed != zlen)
+    return -1;
+
+  out[0] = '*';
+  memcpy (out + 1, escaped.data (), len);
+  return len + 1;
+}
+
 #endif
 
 #ifndef IN_PROCESS_AGENT
@@ -650,6 +694,21 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
   for (i = 0; i < cnt;)
     i += try_rle (buf + i, cnt - i, &csum, &p);
 
+  /* Send large replies compressed instead, if that makes them
+     shorter.  */
+  if (!is_notif && cs.compress_replies && cnt >= COMPRESS_REPLY_THRESHOLD)
+    {
+      int len = compress_reply (buf, cnt, buf2 + 1, p - buf2 - 2);
+
+      if (len > 0)
+	{
+	  csum = 0;
+	  for (i = 1; i <= len; i++)
+	    csum += buf2[i];
+	  p = buf2 + 1 + len;
+	}
+    }
+
   *p++ = '#';
   *p++ = tohex ((csum >> 4) & 0xf);
   *p++ = tohex (csum & 0xf);
@@ -1050,6 +1109,70 @@ outreg (struct regcache *regcache, int regno, char *buf)
   return buf;
 }
 
+/* Return true if register REGNO is among the expedited registers of
+   TDESC, which are always sent in stop replies.  */
+
+static bool
+expedited_by_tdesc (const struct target_desc *tdesc, int regno)
+{
+  for (const char **regp = tdesc->expedite_regs; *regp != nullptr; regp++)
+    if (strcmp (tdesc->reg_defs[regno].name, *regp) == 0)
+      return true;
+
+  return false;
+}
+
+/* Write the "stack" stop reply field GDB asked for with the
+   QExpediteStack packet to BUF: the address held in the stack pointer
+   register, and the contents of the memory from there, as much as can
+   be read and fits before BUF_END.  Return the end of the field.  */
+
+static char *
+outstack (struct regcache *regcache, char *buf, char *buf_end)
+{
+  client_state &cs = get_client_state ();
+  int regno = cs.expedite_stack_regno;
+
+  if (regno < 0 || regno >= regcache->tdesc->reg_defs.size ()
+      || register_size (regcache->tdesc, regno) > sizeof (ULONGEST))
+    return buf;
+
+  CORE_ADDR sp = regcache_raw_get_unsigned (regcache, regno);
+  const char *addr = paddress (sp);
+  long room = (buf_end - buf - (long) strlen (addr) - 8) / 2;
+  int len = std::min ((long) cs.expedite_stack_size, room);
+  if (len <= 0)
+    return buf;
+
+  /* The stack may end less than LEN bytes from SP.  Then send what
+     can be read, in chunks.  */
+  gdb::byte_vector data (len);
+  if (read_inferior_memory (sp, data.data (), len) != 0)
+    {
+      const int chunk = 256;
+      int done = 0;
+
+      while (done < len)
+	{
+	  int n = std::min (chunk, len - done);
+
+	  if (read_inferior_memory (sp + done, data.data () + done, n) != 0)
+	    break;
+	  done += n;
+	}
+      len = done;
+    }
+  if (len == 0)
+    return buf;
+
+  sprintf (buf, "stack:%s,", addr);
+  buf += strlen (buf);
+  buf += 2 * bin2hex (data.data (), buf, len);
+  *buf++ = ';';
+
+  return buf;
+}
+
 void
 prepare_resume_reply (char *buf, ptid_t ptid, const target_waitstatus &status)
 {
@@ -1193,6 +1316,22 @@ prepare_resume_reply (char *buf, ptid_t ptid, const target_waitstatus &status)
 	    buf = outreg (regcache, find_regno (regcache->tdesc, *regp), buf);
 	    regp ++;
 	  }
+
+	/* Then the registers and memory GDB asked for, as long as they
+	   leave room for the fields below.  */
+	char *buf_end = buf_start + PBUFSIZ - 256;
+
+	for (int regno : cs.expedite_regs)
+	  if (regno < regcache->tdesc->reg_defs.size ()
+	      && !expedited_by_tdesc (regcache->tdesc, regno)
+	      && (buf + 2 * register_size (regcache->tdesc, regno) + 6
+		  < buf_end))
+	    buf = outreg (regcache, regno, buf);
+
+	/* Other threads may be running in non-stop mode, so the memory
+	   could be stale by the time GDB reads it.  */
+	if (cs.expedite_stack_size > 0 && !non_stop)
+	  buf = outstack (regcache, buf, buf_end);
 	*buf = '\0';
 
 	/* Formerly, if the debugger had not used any thread features
@@ -778,6 +778,72 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (startswith (own_buf, "QCompressReplies:"))
+    {
+      /* Only zlib is supported.  */
+      if (strcmp (own_buf + strlen ("QCompressReplies:"), "zlib") != 0)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      remote_debug_printf ("[compressed replies enabled]");
+
+      cs.compress_replies = true;
+      write_ok (own_buf);
+      return;
+    }
+
+  if (startswith (own_buf, "QExpediteRegisters:"))
+    {
+      std::vector<int> regs;
+      const char *p = own_buf + strlen ("QExpediteRegisters:");
+
+      while (*p != '\0')
+	{
+	  ULONGEST regno;
+	  const char *end = unpack_varlen_hex (p, &regno);
+
+	  /* Stop replies have room for four hex digits.  */
+	  if (end == p || (*end != ';' && *end != '\0') || regno > 0xffff)
+	    {
+	      write_enn (own_buf);
+	      return;
+	    }
+	  regs.push_back (regno);
+
+	  p = *end == ';' ? end + 1 : end;
+	}
+
+      cs.expedite_regs = std::move (regs);
+      write_ok (own_buf);
+      return;
+    }
+
+  if (startswith (own_buf, "QExpediteStack:"))
+    {
+      ULONGEST regno, size;
+      const char *p = unpack_varlen_hex (own_buf + strlen ("QExpediteStack:"),
+					 &regno);
+
+      if (*p != ',')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p = unpack_varlen_hex (p + 1, &size);
+      if (*p != '\0' || regno > 0xffff || size > PBUFSIZ / 4)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      cs.expedite_stack_regno = regno;
+      cs.expedite_stack_size = size;
+      write_ok (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "QNonStop:"))
     {
       char *mode = own_buf + 9;
@@ -2526,6 +2592,21 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (target_supports_memory_tagging ())
 	strcat (own_buf, ";memory-tagging+");
 
+      /* Packets that arrive while one is being handled are buffered,
+	 and handled in order once it is done (see reschedule in
+	 remote-utils.cc), so GDB can send several memory reads without
+	 waiting for each reply.  */
+      strcat (own_buf, ";pipelined-memory-reads+");
+
+      /* Likewise for vFile:pread.  */
+      strcat (own_buf, ";pipelined-file-reads+");
+
+      strcat (own_buf, ";vReadMemory+");
+
+      strcat (own_buf, ";QCompressReplies+");
+
+      strcat (own_buf, ";QExpediteRegisters+;QExpediteStack+");
+
       /* Reinitialize components as needed for the new connection.  */
       hostio_handle_new_gdb_connection ();
       target_handle_new_gdb_connection ();
@@ -3154,6 +3235,97 @@ handle_v_kill (char *own_buf)
     write_enn (own_buf);
 }
 
+/* Handle a vReadMemory packet, which reads several ranges of memory
+   at once: "vReadMemory:ADDR,LENGTH;ADDR,LENGTH...".  The reply has
+   one field per range, separated by ';': the contents of the range in
+   hex, or "E01" if it could not be read completely.  */
+
+static void
+handle_v_read_memory (char *own_buf)
+{
+  client_state &cs = get_client_state ();
+  std::vector<memory_read_range> ranges;
+  const char *p = own_buf + strlen ("vReadMemory:");
+  size_t reply_len = 0;
+
+  while (*p != '\0')
+    {
+      ULONGEST addr, len;
+
+      p = unpack_varlen_hex (p, &addr);
+      if (*p != ',')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p = unpack_varlen_hex (p + 1, &len);
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      /* Each range takes twice its length in hex in the reply, plus
+	 a separator, and the whole reply must fit in a packet.  */
+      if (len > PBUFSIZ / 2)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      reply_len += 2 * len + 1;
+      if (reply_len >= PBUFSIZ)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      ranges.push_back ({(CORE_ADDR) addr, nullptr, (int) len, false});
+    }
+
+  if (ranges.empty ())
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  unsigned char *buf = mem_buf;
+  for (memory_read_range &range : ranges)
+    {
+      range.buf = buf;
+      buf += range.len;
+    }
+
+  if (cs.current_traceframe >= 0)
+    {
+      for (memory_read_range &range : ranges)
+	range.read = (gdb_read_memory (range.addr, range.buf, range.len)
+		      == range.len);
+    }
+  else if (prepare_to_access_memory () == 0)
+    {
+      if (set_desired_thread ())
+	read_inferior_memory_batch (ranges);
+      done_accessing_memory ();
+    }
+
+  char *out = own_buf;
+  for (const memory_read_range &range : ranges)
+    {
+      if (out != own_buf)
+	*out++ = ';';
+      if (range.read)
+	out += 2 * bin2hex (range.buf, out, range.len);
+      else
+	{
+	  strcpy (out, "E01");
+	  out += 3;
+	}
+    }
+  *out = '\0';
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -3228,6 +3400,17 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (startswith (own_buf, "vReadMemory:"))
+    {
+      if (!target_running ())
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      handle_v_read_memory (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "vKill;"))
     {
       if (!target_running ())
@@ -4008,6 +4191,9 @@ captured_main (int argc, char *argv[])
   while (1)
     {
       cs.noack_mode = 0;
+      cs.compress_replies = false;
+      cs.expedite_regs.clear ();
+      cs.expedite_stack_size = 0;
       cs.multi_process = 0;
       cs.report_fork_events = 0;
       cs.report_vfork_events = 0;
@@ -193,6 +193,20 @@ struct client_state
   /* If true, memory tagging features are supported.  */
   bool memory_tagging_feature = false;
 
+  /* If true, GDB has requested that large replies be compressed.  */
+  bool compress_replies = false;
+
+  /* The registers GDB asked to be sent in stop replies, in addition
+     to the expedited registers of the target description, with the
+     QExpediteRegisters packet.  */
+  std::vector<int> expedite_regs;
+
+  /* The register holding the stack pointer, and the number of bytes
+     of memory from its address to send in stop replies, as set by the
+     QExpediteStack packet.  */
+  int expedite_stack_regno = -1;
+  int expedite_stack_size = 0;
+
 };
 
 client_state &get_client_state ();
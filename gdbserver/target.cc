@@ -130,6 +130,35 @@ read_inferior_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
   return res;
 }
 
+/* See target.h.  */
+
+void
+read_inferior_memory_batch (gdb::array_view<memory_read_range> ranges)
+{
+  while (!ranges.empty ())
+    {
+      int done = the_target->read_memory_batch (ranges);
+
+      for (memory_read_range &range : ranges.slice (0, done))
+	{
+	  range.read = true;
+	  check_mem_read (range.addr, range.buf, range.len);
+	}
+      ranges = ranges.slice (done);
+
+      /* The target couldn't read the next range completely, or at
+	 all.  Read it the usual way, then go on with the rest.  */
+      if (!ranges.empty ())
+	{
+	  memory_read_range &range = ranges[0];
+
+	  range.read = read_inferior_memory (range.addr, range.buf,
+					     range.len) == 0;
+	  ranges = ranges.slice (1);
+	}
+    }
+}
+
 /* See target/target.h.  */
 
 int
@@ -372,6 +401,13 @@ process_stratum_target::done_accessing_memory ()
   /* Nop.  */
 }
 
+int
+process_stratum_target::read_memory_batch
+  (gdb::array_view<memory_read_range> ranges)
+{
+  return 0;
+}
+
 void
 process_stratum_target::look_up_symbols ()
 {
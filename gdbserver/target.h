@@ -65,6 +65,23 @@ struct thread_resume
   CORE_ADDR step_range_end;	/* Exclusive */
 };
 
+/* A range of memory to read with read_inferior_memory_batch.  */
+
+struct memory_read_range
+{
+  /* The address of the first byte to read.  */
+  CORE_ADDR addr;
+
+  /* The buffer to read into.  It is LEN bytes long.  */
+  unsigned char *buf;
+
+  /* The number of bytes to read.  */
+  int len;
+
+  /* Set to whether the whole range could be read.  */
+  bool read;
+};
+
 /* GDBserver doesn't have a concept of strata like GDB, but we call
    its target vector "process_stratum" anyway for the benefit of
    shared code.  */
@@ -165,6 +182,16 @@ class process_stratum_target
   virtual int read_memory (CORE_ADDR memaddr, unsigned char *myaddr,
 			   int len) = 0;
 
+  /* Read several ranges of memory from the inferior process, with
+     fewer system calls than reading them one at a time.  This should
+     generally be called through read_inferior_memory_batch, which
+     handles breakpoint shadowing and reads the ranges this can't
+     with read_memory.
+
+     Read the ranges in order, and return the number of ranges from
+     the start of RANGES that were read completely.  */
+  virtual int read_memory_batch (gdb::array_view<memory_read_range> ranges);
+
   /* Write memory to the inferior process.  This should generally be
      called through target_write_memory, which handles breakpoint shadowing.
 
@@ -720,6 +747,12 @@ target_thread_pending_child (thread_info *thread)
 
 int read_inferior_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len);
 
+/* Read the memory RANGES from the inferior process, setting the READ
+   field of each.  Like read_inferior_memory, this handles breakpoint
+   shadowing.  */
+
+void read_inferior_memory_batch (gdb::array_view<memory_read_range> ranges);
+
 int set_desired_thread ();
 
 std::string target_pid_to_str (ptid_t);
@@ -21,6 +21,7 @@
 #define GDBSUPPORT_PARALLEL_FOR_H
 
 #include <algorithm>
+#include "gdbsupport/function-view.h"
 #if CXX_STD_THREAD
 #include <thread>
 #include "gdbsupport/thread-pool.h"
@@ -35,11 +36,20 @@ namespace gdb
 
    This approach was chosen over having the callback work on single
    items because it makes it simple for the caller to do
-   once-per-subrange initialization and destruction.  */
+   once-per-subrange initialization and destruction.
+
+   By default each subrange has about the same number of elements.
+   When the cost of processing an element varies a lot, this leaves
+   some threads idle while others are still working.  In that case
+   TASK_SIZE can be passed; it is called once for each element, and
+   should return a (non-zero) estimate of how expensive processing
+   that element is.  The range is then split so that each subrange
+   has about the same total estimated size instead.  */
 
 template<class RandomIt, class RangeFunction>
 void
-parallel_for_each (RandomIt first, RandomIt last, RangeFunction callback)
+parallel_for_each (RandomIt first, RandomIt last, RangeFunction callback,
+		   gdb::function_view<size_t (RandomIt)> task_size = nullptr)
 {
 #if CXX_STD_THREAD
   /* So we can use a local array below.  */
@@ -57,10 +67,31 @@ parallel_for_each (RandomIt first, RandomIt last, RangeFunction callback)
       if (n_elements / n_threads < 10)
 	n_threads = std::max (n_elements / 10, (size_t) 1);
       size_t elts_per_thread = n_elements / n_threads;
+
+      size_t total_size = 0;
+      if (task_size != nullptr)
+	for (RandomIt iter = first; iter != last; ++iter)
+	  total_size += task_size (iter);
+      size_t size_per_thread = total_size / n_threads;
+
       n_actual_threads = n_threads - 1;
       for (int i = 0; i < n_actual_threads; ++i)
 	{
-	  RandomIt end = first + elts_per_thread;
+	  RandomIt end;
+	  if (task_size == nullptr)
+	    end = first + elts_per_thread;
+	  else
+	    {
+	      /* Always hand at least one element to each thread, and
+		 leave at least one for each of the remaining ones.  */
+	      RandomIt limit = last - (n_actual_threads - i);
+	      size_t size = 0;
+	      for (end = first; end < limit && size < size_per_thread; ++end)
+		size += task_size (end);
+	      if (end == first)
+		++end;
+	    }
+
 	  auto task = [=] ()
 		      {
 			callback (first, end);
@@ -84,7 +84,7 @@ thread_pool *thread_pool::g_thread_pool = new thread_pool ();
 
 thread_pool::~thread_pool ()
 {
-  /* Because this is a singleton, we don't need to clean up.  The
+  /* Because pools are never destroyed, we don't need to clean up.  The
      threads are detached so that they won't prevent process exit.
      And, cleaning up here would be actively harmful in at least one
      case -- see the comment by the definition of g_thread_pool.  */
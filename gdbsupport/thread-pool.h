@@ -34,15 +34,22 @@ namespace gdb
 
 /* A thread pool.
 
-   There is a single global thread pool, see g_thread_pool.  Tasks can
-   be submitted to the thread pool.  They will be processed in worker
-   threads as time allows.  */
+   There is a global thread pool, see g_thread_pool.  Tasks can be
+   submitted to the thread pool.  They will be processed in worker
+   threads as time allows.
+
+   Since the tasks are processed in order, a long task delays all those
+   submitted after it.  Work that may take long, and that nothing waits
+   for right away, can be given a pool of its own instead.  Like the
+   global pool, such a pool must be allocated on the heap and never
+   destroyed, see the comment by the definition of g_thread_pool.  */
 class thread_pool
 {
 public:
-  /* The sole global thread pool.  */
+  /* The global thread pool.  */
   static thread_pool *g_thread_pool;
 
+  thread_pool () = default;
   ~thread_pool ();
   DISABLE_COPY_AND_ASSIGN (thread_pool);
 
@@ -62,8 +69,6 @@ class thread_pool
 
 private:
 
-  thread_pool () = default;
-
   /* The callback for each worker thread.  */
   void thread_function ();
 
@@ -22,13 +22,34 @@
 
 #include "gold.h"
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
+// Sections larger than this are compressed in independent chunks of
+// this size, in parallel.  The size does not depend on the number of
+// threads, so the output is the same however many threads are used.
+
+const off_t compress_chunk_size = 1024 * 1024;
+
+// Return the zlib compression level to use.
+
+static int
+zlib_compress_level()
+{
+  if (parameters->options().optimize() >= 1)
+    return 9;
+  else
+    return 1;
+}
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
@@ -48,17 +69,11 @@ zlib_compress(int header_size,
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
   *compressed_data = new unsigned char[*compressed_size + header_size];
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
-
   int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
                      compressed_size,
                      reinterpret_cast<const Bytef*>(uncompressed_data),
                      uncompressed_size,
-                     compress_level);
+                     zlib_compress_level());
   if (rc == Z_OK)
     {
       *compressed_size += header_size;
@@ -72,6 +87,49 @@ zlib_compress(int header_size,
     }
 }
 
+// Compress one chunk of a section as raw deflate data, without the
+// zlib header and trailer.  Unless IS_LAST is true, the data ends
+// with a sync flush, so that it is byte aligned and can be followed
+// by the data for the next chunk in the same deflate stream.  On
+// success this allocates the compressed data using new.
+
+static bool
+zlib_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    bool is_last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  z_stream strm;
+  memset(&strm, 0, sizeof strm);
+  if (deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -MAX_WBITS, 8,
+		   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  // Leave room for the empty stored block written by the sync flush.
+  unsigned long buffer_size = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[buffer_size];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = *compressed_data;
+  strm.avail_out = buffer_size;
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = (strm.avail_in == 0
+	     && (is_last
+		 ? rc == Z_STREAM_END
+		 : rc == Z_OK && strm.avail_out != 0));
+  *compressed_size = buffer_size - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!ok)
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+    }
+  return ok;
+}
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -115,6 +173,64 @@ zlib_decompress(const unsigned char* compressed_data,
   return true;
 }
 
+#ifdef HAVE_ZSTD
+
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE with zstd.
+// This works like zlib_compress: on success it allocates memory for
+// the compressed data using new, leaving HEADER_SIZE bytes at the
+// start for the caller to fill in, and sets *COMPRESSED_DATA and
+// *COMPRESSED_SIZE.
+
+static bool
+zstd_compress(int header_size,
+	      const unsigned char* uncompressed_data,
+	      unsigned long uncompressed_size,
+	      unsigned char** compressed_data,
+	      unsigned long* compressed_size)
+{
+  size_t bound = ZSTD_compressBound(uncompressed_size);
+  *compressed_data = new unsigned char[bound + header_size];
+
+  int compress_level;
+  if (parameters->options().optimize() >= 1)
+    compress_level = ZSTD_CLEVEL_DEFAULT;
+  else
+    compress_level = 1;
+
+  size_t rc = ZSTD_compress(*compressed_data + header_size, bound,
+			    uncompressed_data, uncompressed_size,
+			    compress_level);
+  if (!ZSTD_isError(rc))
+    {
+      *compressed_size = rc + header_size;
+      return true;
+    }
+  else
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+}
+
+// Decompress zstd COMPRESSED_DATA of size COMPRESSED_SIZE into
+// UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true if it
+// decompressed successfully.  As with zlib_decompress, the section
+// may consist of several frames; ZSTD_decompress handles that.
+
+static bool
+zstd_decompress(const unsigned char* compressed_data,
+		unsigned long compressed_size,
+		unsigned char* uncompressed_data,
+		unsigned long uncompressed_size)
+{
+  size_t rc = ZSTD_decompress(uncompressed_data, uncompressed_size,
+			      compressed_data, compressed_size);
+  return !ZSTD_isError(rc) && rc == uncompressed_size;
+}
+
+#endif // defined(HAVE_ZSTD)
+
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
 
@@ -148,20 +264,19 @@ decompress_input_section(const unsigned char* compressed_data,
   if ((sh_flags & elfcpp::SHF_COMPRESSED) != 0)
     {
       unsigned int compression_header_size;
+      elfcpp::Elf_Word ch_type;
       if (size == 32)
 	{
 	  compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
 	  if (big_endian)
 	    {
 	      elfcpp::Chdr<32, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	  else
 	    {
 	      elfcpp::Chdr<32, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	}
       else if (size == 64)
@@ -170,23 +285,34 @@ decompress_input_section(const unsigned char* compressed_data,
 	  if (big_endian)
 	    {
 	      elfcpp::Chdr<64, true> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	  else
 	    {
 	      elfcpp::Chdr<64, false> chdr(compressed_data);
-	      if (chdr.get_ch_type() != elfcpp::ELFCOMPRESS_ZLIB)
-		return false;
+	      ch_type = chdr.get_ch_type();
 	    }
 	}
       else
 	gold_unreachable();
 
-      return zlib_decompress(compressed_data + compression_header_size,
-			     compressed_size - compression_header_size,
-			     uncompressed_data,
-			     uncompressed_size);
+      switch (ch_type)
+	{
+	case elfcpp::ELFCOMPRESS_ZLIB:
+	  return zlib_decompress(compressed_data + compression_header_size,
+				 compressed_size - compression_header_size,
+				 uncompressed_data,
+				 uncompressed_size);
+#ifdef HAVE_ZSTD
+	case elfcpp::ELFCOMPRESS_ZSTD:
+	  return zstd_decompress(compressed_data + compression_header_size,
+				 compressed_size - compression_header_size,
+				 uncompressed_data,
+				 uncompressed_size);
+#endif
+	default:
+	  return false;
+	}
     }
 
   const unsigned int zlib_header_size = 12;
@@ -209,10 +335,216 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// A Compress_chunk_task compresses one chunk of an
+// Output_compressed_section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, size_t chunk,
+		      Task_token* blocker)
+    : os_(os), chunk_(chunk), blocker_(blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  std::string
+  get_name() const
+  { return std::string("Compress_chunk_task ") + this->os_->name(); }
+
+ private:
+  Output_compressed_section* const os_;
+  const size_t chunk_;
+  Task_token* const blocker_;
+};
+
 // Class Output_compressed_section.
 
+// Return the type of compression requested by the options.
+
+Output_compressed_section::Compression_type
+Output_compressed_section::compression_type() const
+{
+  const char* compress = this->options_->compress_debug_sections();
+  if (strcmp(compress, "zlib-gnu") == 0)
+    return COMPRESS_GNU_ZLIB;
+  else if (strcmp(compress, "zlib-gabi") == 0
+	   || strcmp(compress, "zlib") == 0)
+    return COMPRESS_GABI_ZLIB;
+  else if (strcmp(compress, "zstd") == 0)
+    return COMPRESS_GABI_ZSTD;
+  else
+    return COMPRESS_NONE;
+}
+
+// At this point the contents of all regular input sections will have
+// been copied into the postprocessing buffer, and relocations will
+// have been applied.  Copy in the contents of anything other than a
+// regular input section.
+
+void
+Output_compressed_section::write_contents()
+{
+  if (!this->have_contents_)
+    {
+      this->write_to_postprocessing_buffer();
+      this->have_contents_ = true;
+    }
+}
+
+// Split a large section into chunks, and queue a task to compress
+// each one.  The chunks are combined by set_final_data_size.
+
+void
+Output_compressed_section::queue_compress_tasks(Workqueue* workqueue,
+						Task_token* blocker)
+{
+  Compression_type type = this->compression_type();
+  if (type == COMPRESS_NONE)
+    return;
+#ifndef HAVE_ZSTD
+  if (type == COMPRESS_GABI_ZSTD)
+    return;
+#endif
+
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+  if (uncompressed_size <= compress_chunk_size)
+    return;
+
+  this->write_contents();
+
+  size_t count = (uncompressed_size + compress_chunk_size - 1)
+		 / compress_chunk_size;
+  this->chunks_.resize(count);
+  for (size_t i = 0; i < count; ++i)
+    {
+      Compressed_chunk* chunk = &this->chunks_[i];
+      chunk->offset = i * compress_chunk_size;
+      chunk->size = std::min(compress_chunk_size,
+			     uncompressed_size - chunk->offset);
+      chunk->data = NULL;
+      chunk->data_size = 0;
+      chunk->adler = 0;
+    }
+
+  blocker->add_blockers(count);
+  for (size_t i = 0; i < count; ++i)
+    workqueue->queue(new Compress_chunk_task(this, i, blocker));
+}
+
+// Compress chunk I.  This may run in parallel with the other chunks.
+
+void
+Output_compressed_section::compress_chunk(size_t i)
+{
+  Compressed_chunk* chunk = &this->chunks_[i];
+  const unsigned char* p = this->postprocessing_buffer() + chunk->offset;
+  switch (this->compression_type())
+    {
+    case COMPRESS_GNU_ZLIB:
+    case COMPRESS_GABI_ZLIB:
+      chunk->adler = adler32(adler32(0, Z_NULL, 0), p, chunk->size);
+      zlib_compress_chunk(p, chunk->size, i + 1 == this->chunks_.size(),
+			  &chunk->data, &chunk->data_size);
+      break;
+#ifdef HAVE_ZSTD
+    case COMPRESS_GABI_ZSTD:
+      // zstd frames may simply be concatenated.
+      zstd_compress(0, p, chunk->size, &chunk->data, &chunk->data_size);
+      break;
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
+// Combine the compressed chunks into the compressed section data.
+// For zlib, the raw deflate data of the chunks forms a single deflate
+// stream, which we wrap in a zlib header and trailer; the Adler-32
+// checksum of the whole section is computed from those of the chunks.
+
+bool
+Output_compressed_section::combine_chunks(Compression_type type,
+					  int header_size,
+					  unsigned long* compressed_size)
+{
+  const bool is_zlib = type != COMPRESS_GABI_ZSTD;
+  bool ok = true;
+  unsigned long total_size = header_size;
+  if (is_zlib)
+    total_size += 2 + 4;
+  for (std::vector<Compressed_chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	ok = false;
+      total_size += p->data_size;
+    }
+
+  unsigned char* out = NULL;
+  if (ok)
+    {
+      this->data_ = new unsigned char[total_size];
+      out = this->data_ + header_size;
+      if (is_zlib)
+	{
+	  // CMF is deflate with a 32K window.  FLEVEL records the
+	  // compression level, and FCHECK makes the header a multiple
+	  // of 31.
+	  const unsigned int cmf = 0x78;
+	  unsigned int flg = zlib_compress_level() >= 7 ? 3 << 6 : 0;
+	  flg += (31 - ((cmf << 8) + flg) % 31) % 31;
+	  *out++ = cmf;
+	  *out++ = flg;
+	}
+    }
+
+  unsigned long adler = 0;
+  for (std::vector<Compressed_chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (out != NULL)
+	{
+	  memcpy(out, p->data, p->data_size);
+	  out += p->data_size;
+	  if (p == this->chunks_.begin())
+	    adler = p->adler;
+	  else
+	    adler = adler32_combine(adler, p->adler, p->size);
+	}
+      delete[] p->data;
+    }
+  this->chunks_.clear();
+
+  if (!ok)
+    return false;
+
+  if (is_zlib)
+    {
+      elfcpp::Swap_unaligned<32, true>::writeval(out, adler);
+      out += 4;
+    }
+  gold_assert(out == this->data_ + total_size);
+  *compressed_size = total_size;
+  return true;
+}
+
 // Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// we actually compress the section data, unless that was already
+// done in chunks by queue_compress_tasks.
 
 void
 Output_compressed_section::set_final_data_size()
@@ -223,22 +555,17 @@ Output_compressed_section::set_final_data_size()
   unsigned long compressed_size;
   unsigned char* uncompressed_data = this->postprocessing_buffer();
 
-  // At this point the contents of all regular input sections will
-  // have been copied into the postprocessing buffer, and relocations
-  // will have been applied.  Now we need to copy in the contents of
-  // anything other than a regular input section.
-  this->write_to_postprocessing_buffer();
+  this->write_contents();
 
   bool success = false;
-  enum { none, gnu_zlib, gabi_zlib } compress;
+  Compression_type compress = this->compression_type();
   int compression_header_size = 12;
+  elfcpp::Elf_Word ch_type = elfcpp::ELFCOMPRESS_ZLIB;
   const int size = parameters->target().get_size();
-  if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
-    compress = gnu_zlib;
-  else if (strcmp(this->options_->compress_debug_sections(), "zlib-gabi") == 0
-	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
+  if (compress == COMPRESS_GABI_ZLIB || compress == COMPRESS_GABI_ZSTD)
     {
-      compress = gabi_zlib;
+      if (compress == COMPRESS_GABI_ZSTD)
+	ch_type = elfcpp::ELFCOMPRESS_ZSTD;
       if (size == 32)
 	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
       else if (size == 64)
@@ -246,16 +573,23 @@ Output_compressed_section::set_final_data_size()
       else
 	gold_unreachable();
     }
-  else
-    compress = none;
-  if (compress != none)
+  if (!this->chunks_.empty())
+    success = this->combine_chunks(compress, compression_header_size,
+				   &compressed_size);
+  else if (compress == COMPRESS_GNU_ZLIB || compress == COMPRESS_GABI_ZLIB)
     success = zlib_compress(compression_header_size, uncompressed_data,
 			    uncompressed_size, &this->data_,
 			    &compressed_size);
+#ifdef HAVE_ZSTD
+  else if (compress == COMPRESS_GABI_ZSTD)
+    success = zstd_compress(compression_header_size, uncompressed_data,
+			    uncompressed_size, &this->data_,
+			    &compressed_size);
+#endif
   if (success)
     {
       elfcpp::Elf_Xword flags = this->flags();
-      if (compress == gabi_zlib)
+      if (compress != COMPRESS_GNU_ZLIB)
 	{
 	  // Set the SHF_COMPRESSED bit.
 	  flags |= elfcpp::SHF_COMPRESSED;
@@ -266,14 +600,14 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<32, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
 	      else
 		{
 		  elfcpp::Chdr_write<32, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		}
@@ -283,7 +617,7 @@ Output_compressed_section::set_final_data_size()
 	      if (is_big_endian)
 		{
 		  elfcpp::Chdr_write<64, true> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -292,7 +626,7 @@ Output_compressed_section::set_final_data_size()
 	      else
 		{
 		  elfcpp::Chdr_write<64, false> chdr(this->data_);
-		  chdr.put_ch_type(elfcpp::ELFCOMPRESS_ZLIB);
+		  chdr.put_ch_type(ch_type);
 		  chdr.put_ch_size(uncompressed_size);
 		  chdr.put_ch_addralign(addralign);
 		  // Clear the reserved field.
@@ -317,7 +651,10 @@ Output_compressed_section::set_final_data_size()
     }
   else
     {
-      gold_warning(_("not compressing section data: zlib error"));
+      if (compress == COMPRESS_GABI_ZSTD)
+	gold_warning(_("not compressing section data: zstd error"));
+      else
+	gold_warning(_("not compressing section data: zlib error"));
       gold_assert(this->data_ == NULL);
       this->set_data_size(uncompressed_size);
     }
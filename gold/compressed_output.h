@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,22 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), chunks_(), have_contents_(false)
   { this->set_requires_postprocessing(); }
 
+  // Queue tasks to compress the contents of the section in
+  // independent chunks.  Each task adds a blocker to BLOCKER.  This is
+  // called after all the input sections have been written to the
+  // postprocessing buffer, and before set_final_data_size.  Small
+  // sections are left for set_final_data_size to compress.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* blocker);
+
+  // Compress chunk I of the section.  This is called by the tasks
+  // queued by queue_compress_tasks.
+  void
+  compress_chunk(size_t i);
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +89,54 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // The type of compression to apply.
+  enum Compression_type
+  {
+    COMPRESS_NONE,
+    COMPRESS_GNU_ZLIB,
+    COMPRESS_GABI_ZLIB,
+    COMPRESS_GABI_ZSTD
+  };
+
+  // A chunk of the section which is compressed independently.
+  struct Compressed_chunk
+  {
+    // The offset and size of the chunk in the postprocessing buffer.
+    off_t offset;
+    off_t size;
+    // The compressed data, or NULL if compression failed.
+    unsigned char* data;
+    unsigned long data_size;
+    // The Adler-32 checksum of the uncompressed chunk, for zlib.
+    unsigned long adler;
+  };
+
+  // Return the type of compression requested by the options.
+  Compression_type
+  compression_type() const;
+
+  // Write the contents of anything other than a regular input
+  // section into the postprocessing buffer, if not already done.
+  void
+  write_contents();
+
+  // Combine the compressed chunks into a single compressed stream,
+  // leaving HEADER_SIZE bytes for the compression header.  Return
+  // false if any chunk failed to compress.
+  bool
+  combine_chunks(Compression_type, int header_size,
+		 unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The chunks compressed by queue_compress_tasks, if any.
+  std::vector<Compressed_chunk> chunks_;
+  // Whether write_contents has been called.
+  bool have_contents_;
 };
 
 } // End namespace gold.
@@ -45,6 +45,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -108,9 +109,14 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), machine_(0), size_(0),
+      big_endian_(false), osabi_(0), abiversion_(0), is_compressed_(),
+      sect_offsets_(), str_offset_map_(), debug_types_(), debug_str_(0),
+      debug_cu_index_(0), debug_tu_index_(0), str_hashes_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,10 +125,27 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
+  // Return the file name.
+  const char*
+  name() const
+  { return this->name_; }
+
   // Read the input file and send its contents to OUTPUT_FILE.
   void
   read(Dwp_output_file* output_file);
 
+  // Open the input file and find its debug sections.  If HASH_STRINGS
+  // is true, also compute the hash codes of the strings in the string
+  // table.  This does not touch the output file, so it may be done
+  // for several input files in parallel.
+  void
+  read_input(bool hash_strings);
+
+  // Send the contents of the input file to OUTPUT_FILE.  This must
+  // be done for each input file in turn, after read_input.
+  void
+  add_to_output(Dwp_output_file* output_file);
+
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
   // were found.
@@ -145,15 +168,18 @@ class Dwo_file
   };
 
   // Create a Sized_relobj_dwo of the given size and endianness,
-  // and record the target info.  P is a pointer to the ELF header
+  // and save the target info.  P is a pointer to the ELF header
   // in memory.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
+
+  // Compute the hash codes of the strings in the string table.
+  void
+  hash_strings();
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -232,12 +258,30 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // ELF header parameters.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // The debug sections found by read_input, indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The .debug_str.dwo section.
+  unsigned int debug_str_;
+  // The .debug_cu_index and .debug_tu_index sections of a .dwp file.
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The hash codes of the strings in the string table, if computed
+  // by read_input.
+  std::vector<size_t> str_hashes_;
 };
 
 // An ELF input file.
@@ -467,6 +511,10 @@ class Dwp_output_file
   section_offset_type
   add_string(const char* str, size_t len);
 
+  // Likewise, but HASH_CODE is the hash code of the string.
+  section_offset_type
+  add_string(const char* str, size_t len, size_t hash_code);
+
   // Add a section to the output file, and return the new section offset.
   section_offset_type
   add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
@@ -801,8 +849,33 @@ Sized_relobj_dwo<size, big_endian>::setup()
   Compressed_section_map* compressed_sections =
       build_compressed_section_map<size, big_endian>(
 	  pshdrs, this->shnum(), names, section_names_size, this, true);
-  if (compressed_sections != NULL && !compressed_sections->empty())
-    this->set_compressed_sections(compressed_sections);
+  if (compressed_sections == NULL || compressed_sections->empty())
+    return;
+  this->set_compressed_sections(compressed_sections);
+
+  // When running with threads, the input files are read in parallel,
+  // so decompress the sections now rather than while copying them to
+  // the output file.  Object::decompressed_section_contents will
+  // return the cached contents.
+  if (!parameters->options().threads())
+    return;
+  for (Compressed_section_map::iterator p = compressed_sections->begin();
+       p != compressed_sections->end();
+       ++p)
+    {
+      if (p->second.contents != NULL)
+	continue;
+      section_size_type len;
+      const unsigned char* contents =
+	  this->do_section_contents(p->first, &len, false);
+      unsigned char* uncompressed_data = new unsigned char[p->second.size];
+      if (!decompress_input_section(contents, len, uncompressed_data,
+				    p->second.size, size, big_endian,
+				    p->second.flag))
+	this->error(_("could not decompress section %s"),
+		    this->do_section_name(p->first).c_str());
+      p->second.contents = uncompressed_data;
+    }
 }
 
 // Return a view of the contents of a section.
@@ -829,7 +902,10 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 Dwo_file::~Dwo_file()
 {
   if (this->obj_ != NULL)
-    delete this->obj_;
+    {
+      this->obj_->discard_decompressed_sections();
+      delete this->obj_;
+    }
   if (this->input_file_ != NULL)
     delete this->input_file_;
 }
@@ -840,7 +916,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -885,20 +961,22 @@ Dwo_file::read_executable(File_list* files)
 void
 Dwo_file::read(Dwp_output_file* output_file)
 {
-  this->obj_ = this->make_object(output_file);
+  this->read_input(false);
+  this->add_to_output(output_file);
+}
+
+// Open the input file and find its debug sections.
+
+void
+Dwo_file::read_input(bool hash_strings)
+{
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  unsigned int* debug_shndx = this->debug_shndx_;
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -920,7 +998,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       if (strcmp(suffix, "info.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
@@ -928,7 +1006,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "loc.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
@@ -936,21 +1014,67 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "macro.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
     }
 
+  if (hash_strings && this->debug_str_ > 0)
+    this->hash_strings();
+}
+
+// Compute the hash codes of the strings in the string table, so that
+// add_strings does not have to.
+
+void
+Dwo_file::hash_strings()
+{
+  section_size_type len;
+  bool is_new;
+  const unsigned char* pdata = this->section_contents(this->debug_str_, &len,
+						      &is_new);
+  const char* p = reinterpret_cast<const char*>(pdata);
+  const char* pend = p + len;
+
+  // add_strings will complain if the last string is not null
+  // terminated.
+  if (len > 0 && pend[-1] == '\0')
+    {
+      while (p < pend)
+	{
+	  size_t slen = strlen(p);
+	  this->str_hashes_.push_back(string_hash<char>(p, slen));
+	  p += slen + 1;
+	}
+    }
+
+  if (is_new)
+    delete[] pdata;
+}
+
+// Send the contents of the input file to OUTPUT_FILE.
+
+void
+Dwo_file::add_to_output(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int* debug_shndx = this->debug_shndx_;
+  const std::vector<unsigned int>& debug_types = this->debug_types_;
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file, this->debug_str_);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
 	  if (debug_types.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
@@ -959,7 +1083,8 @@ Dwo_file::read(Dwp_output_file* output_file)
             debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
@@ -969,7 +1094,7 @@ Dwo_file::read(Dwp_output_file* output_file)
     this->add_unit_set(output_file, debug_shndx, false);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
+  for (std::vector<unsigned int>::const_iterator tp = debug_types.begin();
        tp != debug_types.end();
        ++tp)
     {
@@ -985,7 +1110,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1021,10 +1146,10 @@ Dwo_file::verify(const File_list& files)
 }
 
 // Create a Sized_relobj_dwo of the given size and endianness,
-// and record the target info.
+// and save the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1045,8 +1170,8 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_fatal(_("%s: not an ELF object file"), this->name_);
   
   // Get the size, endianness, machine, etc. info from the header,
-  // make an appropriately-sized Relobj, and pass the target info
-  // to the output object.
+  // make an appropriately-sized Relobj, and save the target info
+  // for the output object.
   int size;
   bool big_endian;
   std::string error;
@@ -1058,15 +1183,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1075,15 +1198,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1092,23 +1213,22 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     gold_unreachable();
 }
 
-// Function template to create a Sized_relobj_dwo and record the target info.
+// Function template to create a Sized_relobj_dwo and save the target info.
 // P is a pointer to the ELF header in memory.
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_ei_osabi(),
-	ehdr.get_ei_abiversion());
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_ei_osabi();
+  this->abiversion_ = ehdr.get_ei_abiversion();
   return obj;
 }
 
@@ -1384,14 +1504,22 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
     ++count;
   this->str_offset_map_.reserve(count + 1);
 
+  // If read_input computed the hash codes, they had better match.
+  bool have_hashes = !this->str_hashes_.empty();
+  gold_assert(!have_hashes || this->str_hashes_.size() == count);
+
   // Add the strings to the output string table, and record the new offsets
   // in the map.
   section_offset_type i = 0;
   section_offset_type new_offset;
+  size_t n = 0;
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
+      if (have_hashes)
+	new_offset = output_file->add_string(p, len, this->str_hashes_[n++]);
+      else
+	new_offset = output_file->add_string(p, len);
       this->str_offset_map_.push_back(std::make_pair(i, new_offset));
       p += len + 1;
       i += len + 1;
@@ -1593,6 +1721,17 @@ Dwp_output_file::add_string(const char* str, size_t len)
   return this->stringpool_.get_offset_from_key(key);
 }
 
+// Add a string whose hash code has already been computed.
+
+section_offset_type
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
+{
+  Stringpool::Key key;
+  this->stringpool_.add_with_length_and_hash(str, len, hash_code, true, &key);
+  this->have_strings_ = true;
+  return this->stringpool_.get_offset_from_key(key);
+}
+
 // Align the file offset to the given boundary.
 
 static inline off_t
@@ -2284,6 +2423,152 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
   this->output_file_->add_tu_set(unit_set);
 }
 
+// This task opens an input file and finds its debug sections.  These
+// tasks run in parallel.  It unblocks BLOCKER when done.
+
+class Dwo_read_task : public Task
+{
+ public:
+  Dwo_read_task(Dwo_file* dwo_file, Task_token* blocker)
+    : dwo_file_(dwo_file), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->read_input(true); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_read_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* blocker_;
+};
+
+// This task adds the contents of an input file to the output file,
+// and then deletes the input file.  The input files must be added in
+// order, so this task waits for THIS_BLOCKER, which is unblocked when
+// the previous file has been added, and for READ_BLOCKER, which is
+// unblocked when the Dwo_read_task for this file is done.  It
+// unblocks NEXT_BLOCKER.  To limit the number of input files open at
+// once, the Dwo_read_task for a later file, NEXT_READ, is queued only
+// when this task runs.
+
+class Dwo_add_task : public Task
+{
+ public:
+  Dwo_add_task(Dwo_file* dwo_file, Dwp_output_file* output_file,
+	       bool verbose, Task_token* this_blocker,
+	       Task_token* read_blocker, Task_token* next_blocker)
+    : dwo_file_(dwo_file), output_file_(output_file), verbose_(verbose),
+      this_blocker_(this_blocker), read_blocker_(read_blocker),
+      next_blocker_(next_blocker), next_read_(NULL)
+  { }
+
+  ~Dwo_add_task()
+  {
+    delete this->this_blocker_;
+    delete this->read_blocker_;
+  }
+
+  // Set the task to queue when this one runs.
+  void
+  set_next_read(Task* next_read)
+  { this->next_read_ = next_read; }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->read_blocker_->is_blocked())
+      return this->read_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    if (this->next_read_ != NULL)
+      workqueue->queue(this->next_read_);
+    if (this->verbose_)
+      fprintf(stderr, "%s\n", this->dwo_file_->name());
+    this->dwo_file_->add_to_output(this->output_file_);
+    delete this->dwo_file_;
+  }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_add_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Dwp_output_file* output_file_;
+  bool verbose_;
+  Task_token* this_blocker_;
+  Task_token* read_blocker_;
+  Task_token* next_blocker_;
+  Task* next_read_;
+};
+
+// Read the input files in parallel using THREAD_COUNT threads, and
+// add their contents to OUTPUT_FILE in order.
+
+static void
+read_dwo_files(const General_options& options, int thread_count,
+	       const File_list& files, Dwp_output_file* output_file,
+	       bool verbose)
+{
+  Workqueue workqueue(options);
+  workqueue.set_thread_count(thread_count);
+
+  // Keep at most two input files per thread open at once.
+  const size_t max_open = 2 * thread_count;
+
+  std::vector<Dwo_read_task*> read_tasks;
+  std::vector<Dwo_add_task*> add_tasks;
+  Task_token* this_blocker = NULL;
+  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+    {
+      Dwo_file* dwo_file = new Dwo_file(f->dwo_name.c_str());
+      Task_token* read_blocker = new Task_token(true);
+      read_blocker->add_blocker();
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      read_tasks.push_back(new Dwo_read_task(dwo_file, read_blocker));
+      add_tasks.push_back(new Dwo_add_task(dwo_file, output_file, verbose,
+					   this_blocker, read_blocker,
+					   next_blocker));
+      this_blocker = next_blocker;
+    }
+
+  for (size_t i = 0; i < files.size(); ++i)
+    {
+      if (i < max_open)
+	workqueue.queue(read_tasks[i]);
+      else
+	add_tasks[i - max_open]->set_next_read(read_tasks[i]);
+      workqueue.queue(add_tasks[i]);
+    }
+
+  workqueue.process(0);
+
+  delete this_blocker;
+}
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,6 +2577,8 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
+  THREAD_COUNT,
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2586,8 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2604,8 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2342,6 +2633,19 @@ This program has absolutely no warranty.\n"));
   exit(EXIT_SUCCESS);
 }
 
+// Return the number of threads to use if --thread-count is not given.
+
+static int
+default_thread_count()
+{
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+  long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (ncpus > 0)
+    return ncpus;
+#endif
+  return 2;
+}
+
 // Main program.
 
 int
@@ -2378,6 +2682,8 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2703,17 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    break;
+	  case THREAD_COUNT:
+	    {
+	      char* endptr;
+	      thread_count = strtol(optarg, &endptr, 0);
+	      if (*endptr != '\0' || thread_count <= 0)
+		gold_fatal(_("invalid thread count: %s"), optarg);
+	    }
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +2722,25 @@ main(int argc, char** argv)
 	}
     }
 
+#ifndef ENABLE_THREADS
+  if (threads)
+    {
+      gold_warning(_("ignoring --threads: "
+		     "%s was compiled without thread support"),
+		   program_name);
+      threads = false;
+    }
+#endif
+
+  // The locks in libgold are only used when threads are enabled, so
+  // this must be set before we open any files.
+  if (threads)
+    {
+      options.enable_threads();
+      if (thread_count == 0)
+	thread_count = default_thread_count();
+    }
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2438,12 +2774,19 @@ main(int argc, char** argv)
 
   // Process each file, adding its contents to the output file.
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  if (threads)
+    read_dwo_files(options, thread_count, files, &output_file, verbose);
+  else
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      for (File_list::const_iterator f = files.begin();
+	   f != files.end();
+	   ++f)
+	{
+	  if (verbose)
+	    fprintf(stderr, "%s\n", f->dwo_name.c_str());
+	  Dwo_file dwo_file(f->dwo_name.c_str());
+	  dwo_file.read(&output_file);
+	}
     }
   output_file.finalize();
 
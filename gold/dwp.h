@@ -119,6 +119,20 @@ inline section_size_type
 convert_to_section_size_type(const From from)
 { return convert_types<section_size_type, From>(from); }
 
+// Hash a string.  This must match gold::string_hash in gold.h, since
+// the hash codes are passed to Stringpool::add_with_length_and_hash.
+
+template<typename Char_type>
+inline size_t
+string_hash(const Char_type* s, size_t length)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  size_t h = 5381;
+  for (size_t i = 0; i < length * sizeof(Char_type); ++i)
+    h = h * 33 + *p++;
+  return h;
+}
+
 }; // End namespace gold.
 
 #endif // !defined(DWP_DWP_H)
@@ -28,6 +28,7 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -171,6 +172,210 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// The results of scanning the .debug_info and .debug_types sections
+// of one input object.  The CU and TU indexes and the symbol list are
+// local to the object; merge_into translates them when it adds them
+// to the Gdb_index, which must be done in input order.  This lets the
+// objects be scanned in parallel while still producing the same
+// .gdb_index section as a serial scan.
+
+class Gdb_index_object_data
+{
+ public:
+  // If COPY_SYMBOLS is true, make a copy of SYMBOLS, since the
+  // sections will be scanned after the caller has freed them.
+  Gdb_index_object_data(Relobj* object, const unsigned char* symbols,
+			off_t symbols_size, bool copy_symbols);
+
+  ~Gdb_index_object_data();
+
+  // The input object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a .debug_info or .debug_types section to be scanned by
+  // scan_sections.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Return whether there are sections waiting to be scanned.
+  bool
+  has_sections() const
+  { return !this->sections_.empty(); }
+
+  // Scan the sections recorded by add_section.
+  void
+  scan_sections();
+
+  // Scan a .debug_info or .debug_types section.
+  void
+  scan_section(bool is_type_unit, unsigned int shndx,
+	       unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Add a compilation unit, returning its local index.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(std::make_pair(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit, returning its local index.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(int cu_index, Dwarf_range_list* ranges)
+  { this->ranges_.push_back(std::make_pair(cu_index, ranges)); }
+
+  // Add a symbol.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Record a compilation unit or type unit without pubnames.
+  void
+  add_nopubnames_unit(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Add the results to GDB_INDEX.
+  void
+  merge_into(Gdb_index* gdb_index);
+
+ private:
+  Gdb_index_object_data(const Gdb_index_object_data&);
+  Gdb_index_object_data& operator=(const Gdb_index_object_data&);
+
+  // A section to scan.
+  struct Section
+  {
+    Section(bool is_tu, unsigned int sec, unsigned int reloc_sec,
+	    unsigned int rtype)
+      : is_type_unit(is_tu), shndx(sec), reloc_shndx(reloc_sec),
+	reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  // A type unit.
+  struct Type_unit
+  {
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    off_t tu_offset;
+    off_t type_offset;
+    uint64_t type_signature;
+  };
+
+  // A symbol.  The name is at NAME_OFFSET in NAMES_.
+  struct Symbol
+  {
+    Symbol(int index, size_t off, unsigned int h, uint8_t f)
+      : cu_index(index), name_offset(off), hash(h), flags(f)
+    { }
+    int cu_index;
+    size_t name_offset;
+    unsigned int hash;
+    uint8_t flags;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr, Gdb_index_info_reader* dwinfo);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo);
+
+  // The input object.
+  Relobj* object_;
+  // The symbol table of the object.
+  const unsigned char* symbols_;
+  off_t symbols_size_;
+  // Whether we own SYMBOLS_.
+  bool owns_symbols_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // Whether we have mapped the pubnames and pubtypes tables.
+  bool pubnames_mapped_;
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames section of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // The compilation units, as (offset, length) pairs.
+  std::vector<std::pair<off_t, off_t> > comp_units_;
+  // The type units.
+  std::vector<Type_unit> type_units_;
+  // The address ranges, as (local CU index, ranges) pairs.
+  std::vector<std::pair<int, Dwarf_range_list*> > ranges_;
+  // The symbols, in the order they were found.
+  std::vector<Symbol> symbols_list_;
+  // The null-terminated symbol names.
+  std::string names_;
+  // Statistics.
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_nopubnames_count_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,15 +388,20 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_object_data* data)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      data_(data), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Add the counts for one input object to the statistics.
+  static void
+  add_stats(unsigned int cu_count, unsigned int cu_nopubnames_count,
+	    unsigned int tu_count, unsigned int tu_nopubnames_count);
+
   // Print usage statistics.
   static void
   print_stats();
@@ -285,8 +495,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The results for the input object.
+  Gdb_index_object_data* data_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,8 +531,7 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->cu_index_ = this->data_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +542,9 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->data_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -380,10 +588,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->data_->add_nopubnames_unit(die->tag()
+					     == elfcpp::DW_TAG_type_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -437,8 +643,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->data_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +682,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->data_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -825,8 +1029,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->data_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1054,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->data_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1079,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->data_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1118,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->data_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1129,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->data_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->data_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1140,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->data_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->data_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->data_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->data_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -964,6 +1165,20 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
+// Add the counts for one input object to the statistics.
+
+void
+Gdb_index_info_reader::add_stats(unsigned int cu_count,
+				 unsigned int cu_nopubnames_count,
+				 unsigned int tu_count,
+				 unsigned int tu_nopubnames_count)
+{
+  Gdb_index_info_reader::dwarf_cu_count += cu_count;
+  Gdb_index_info_reader::dwarf_cu_nopubnames_count += cu_nopubnames_count;
+  Gdb_index_info_reader::dwarf_tu_count += tu_count;
+  Gdb_index_info_reader::dwarf_tu_nopubnames_count += tu_nopubnames_count;
+}
+
 // Print usage statistics.
 void
 Gdb_index_info_reader::print_stats()
@@ -978,53 +1193,44 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
-
-// Construct the .gdb_index section.
-
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+// Class Gdb_index_object_data.
+
+Gdb_index_object_data::Gdb_index_object_data(Relobj* object,
+					     const unsigned char* symbols,
+					     off_t symbols_size,
+					     bool copy_symbols)
+  : object_(object), symbols_(symbols), symbols_size_(symbols_size),
+    owns_symbols_(false), sections_(), pubnames_mapped_(false),
+    cu_pubname_map_(), cu_pubtype_map_(), pubnames_table_(NULL),
+    pubtypes_table_(NULL), stmt_list_offset_(-1), comp_units_(),
+    type_units_(), ranges_(), symbols_list_(), names_(),
+    cu_nopubnames_count_(0), tu_nopubnames_count_(0)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  if (copy_symbols && symbols != NULL)
+    {
+      unsigned char* copy = new unsigned char[symbols_size];
+      memcpy(copy, symbols, symbols_size);
+      this->symbols_ = copy;
+      this->owns_symbols_ = true;
+    }
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_object_data::~Gdb_index_object_data()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
+  if (this->owns_symbols_)
+    delete[] this->symbols_;
 }
 
-
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
 // when we encounter the die for that cu or tu.
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_object_data::map_pubtable_to_dies(unsigned int attr,
+					    Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1042,7 +1248,8 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, this->symbols_,
+			   this->symbols_size_))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1057,30 +1264,21 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_object_data::map_pubnames_and_types_to_dies(
+    Gdb_index_info_reader* dwinfo)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = -1;
-
-  delete this->pubnames_table_;
+  this->pubnames_mapped_ = true;
   this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
   this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_object_data::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1290,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_object_data::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1102,6 +1300,236 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
 
 // Scan a .debug_info or .debug_types input section.
 
+void
+Gdb_index_object_data::scan_section(bool is_type_unit,
+				    unsigned int shndx,
+				    unsigned int reloc_shndx,
+				    unsigned int reloc_type)
+{
+  Gdb_index_info_reader dwinfo(is_type_unit, this->object_,
+			       this->symbols_, this->symbols_size_,
+			       shndx, reloc_shndx,
+			       reloc_type, this);
+  if (!this->pubnames_mapped_)
+    this->map_pubnames_and_types_to_dies(&dwinfo);
+  dwinfo.parse();
+}
+
+// Scan the sections recorded by add_section.
+
+void
+Gdb_index_object_data::scan_sections()
+{
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    this->scan_section(p->is_type_unit, p->shndx, p->reloc_shndx,
+		       p->reloc_type);
+  this->sections_.clear();
+
+  // We don't need the symbols any more.
+  if (this->owns_symbols_)
+    {
+      delete[] this->symbols_;
+      this->symbols_ = NULL;
+      this->owns_symbols_ = false;
+    }
+}
+
+// Add a symbol.  We compute the hash value here, so that it is done
+// in parallel when the objects are scanned in parallel.
+
+void
+Gdb_index_object_data::add_symbol(int cu_index, const char* sym_name,
+				  uint8_t flags)
+{
+  unsigned int hash = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(sym_name));
+  this->symbols_list_.push_back(Symbol(cu_index, this->names_.size(), hash,
+				       flags));
+  this->names_.append(sym_name, strlen(sym_name) + 1);
+}
+
+// Add the results to GDB_INDEX.  The local CU and TU indexes are
+// offset by the number of units already in GDB_INDEX; a TU index is
+// stored as -1 minus its position in the TU list.
+
+void
+Gdb_index_object_data::merge_into(Gdb_index* gdb_index)
+{
+  int cu_base = 0;
+  for (size_t i = 0; i < this->comp_units_.size(); ++i)
+    {
+      int index = gdb_index->add_comp_unit(this->comp_units_[i].first,
+					   this->comp_units_[i].second);
+      if (i == 0)
+	cu_base = index;
+    }
+  int tu_base = 0;
+  for (size_t i = 0; i < this->type_units_.size(); ++i)
+    {
+      const Type_unit& tu(this->type_units_[i]);
+      int index = gdb_index->add_type_unit(tu.tu_offset, tu.type_offset,
+					   tu.type_signature);
+      if (i == 0)
+	tu_base = index;
+    }
+
+  for (size_t i = 0; i < this->ranges_.size(); ++i)
+    {
+      int cu_index = this->ranges_[i].first;
+      cu_index = cu_index < 0 ? cu_index - tu_base : cu_index + cu_base;
+      gdb_index->add_address_range_list(this->object_, cu_index,
+					this->ranges_[i].second);
+    }
+
+  for (std::vector<Symbol>::const_iterator p = this->symbols_list_.begin();
+       p != this->symbols_list_.end();
+       ++p)
+    {
+      int cu_index = p->cu_index < 0 ? p->cu_index - tu_base
+				     : p->cu_index + cu_base;
+      gdb_index->add_symbol(cu_index, this->names_.data() + p->name_offset,
+			    p->hash, p->flags);
+    }
+
+  Gdb_index_info_reader::add_stats(this->comp_units_.size(),
+				   this->cu_nopubnames_count_,
+				   this->type_units_.size(),
+				   this->tu_nopubnames_count_);
+}
+
+// This task scans the .debug_info and .debug_types sections of one
+// input object.  It holds the lock on the object, since the DWARF
+// reader reads the object file.  It unblocks BLOCKER when done.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_object_data* data, Task_token* blocker)
+    : data_(data), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->data_->object();
+    return object->is_locked() ? object->token() : NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->blocker_);
+    Task_token* token = this->data_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->data_->scan_sections();
+    this->data_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->data_->object()->name(); }
+
+ private:
+  Gdb_index_object_data* data_;
+  Task_token* blocker_;
+};
+
+// This task merges the results of the Gdb_index_scan_tasks into the
+// index.  It waits for THIS_BLOCKER, if not NULL, and for
+// SCAN_BLOCKER, and deletes them both.  It unblocks NEXT_BLOCKER.
+
+class Gdb_index_merge_task : public Task
+{
+ public:
+  Gdb_index_merge_task(Gdb_index* gdb_index, Task_token* this_blocker,
+		       Task_token* scan_blocker, Task_token* next_blocker)
+    : gdb_index_(gdb_index), this_blocker_(this_blocker),
+      scan_blocker_(scan_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_merge_task()
+  {
+    delete this->this_blocker_;
+    delete this->scan_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->scan_blocker_->is_blocked())
+      return this->scan_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->merge_object_data(); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_merge_task"; }
+
+ private:
+  Gdb_index* gdb_index_;
+  Task_token* this_blocker_;
+  Task_token* scan_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    object_data_()
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->object_data_.size(); ++i)
+    delete this->object_data_[i];
+}
+
+// Scan a .debug_info or .debug_types input section.  The sections of
+// an object are always scanned together, in order.  When running with
+// threads, copy the symbols, which the caller is about to free, and
+// defer the scan to a Gdb_index_scan_task.  Otherwise scan the
+// section now, and merge the results of the previous object.
+
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
 			   Relobj* object,
@@ -1111,22 +1539,73 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  bool threads = parameters->options().threads();
+  if (this->object_data_.empty()
+      || this->object_data_.back()->object() != object)
+    {
+      if (!threads)
+	this->merge_object_data();
+      this->object_data_.push_back(new Gdb_index_object_data(object, symbols,
+							     symbols_size,
+							     threads));
+    }
+
+  Gdb_index_object_data* data = this->object_data_.back();
+  if (threads)
+    data->add_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+  else
+    data->scan_section(is_type_unit, shndx, reloc_shndx, reloc_type);
+}
+
+// Queue a Gdb_index_scan_task for each object with sections to scan,
+// followed by a Gdb_index_merge_task.
+
+Task_token*
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* this_blocker)
+{
+  Task_token* scan_blocker = NULL;
+  for (unsigned int i = 0; i < this->object_data_.size(); ++i)
+    {
+      Gdb_index_object_data* data = this->object_data_[i];
+      if (!data->has_sections())
+	continue;
+      if (scan_blocker == NULL)
+	scan_blocker = new Task_token(true);
+      scan_blocker->add_blocker();
+      workqueue->queue(new Gdb_index_scan_task(data, scan_blocker));
+    }
+
+  if (scan_blocker == NULL)
+    return this_blocker;
+
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+  workqueue->queue(new Gdb_index_merge_task(this, this_blocker, scan_blocker,
+					    next_blocker));
+  return next_blocker;
+}
+
+// Merge the results of scanning each input object into the index.
+
+void
+Gdb_index::merge_object_data()
+{
+  for (unsigned int i = 0; i < this->object_data_.size(); ++i)
+    {
+      Gdb_index_object_data* data = this->object_data_[i];
+      gold_assert(!data->has_sections());
+      data->merge_into(this);
+      delete data;
+    }
+  this->object_data_.clear();
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name, unsigned int hash,
+		      uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
   this->stringpool_.add(sym_name, true, &sym->name_key);
   sym->hashval = hash;
@@ -1156,32 +1635,14 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
 Gdb_index::set_final_data_size()
 {
+  // Add the results of any objects not yet merged.
+  this->merge_object_data();
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
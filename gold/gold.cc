@@ -134,6 +134,39 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to run the rest of the middle of the link after
+// identical code folding.
+
+class Middle_layout_runner : public Task_function_runner
+{
+ public:
+  Middle_layout_runner(const General_options& options,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Middle_layout_runner::run(Workqueue* workqueue, const Task* task)
+{
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -527,12 +560,41 @@ queue_middle_tasks(const General_options& options,
 
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  ICF is done by a series
+  // of tasks, after which we queue the rest of the middle tasks.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker = new Task_token(true);
+      icf_blocker->add_blocker();
+      symtab->icf()->queue_find_identical_sections(task, workqueue,
+						   input_objects, symtab,
+						   icf_blocker);
+      workqueue->queue(new Task_function(new Middle_layout_runner(options,
+								  input_objects,
+								  symtab,
+								  layout,
+								  mapfile),
+					 icf_blocker,
+					 "Task_function Middle_layout_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, after identical code
+// folding.
+
+void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -777,6 +839,11 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // When running with threads, the .debug_info sections for
+  // --gdb-index are scanned in parallel; that has to be finished
+  // before we lay out the output file.
+  this_blocker = layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -878,9 +945,17 @@ queue_final_tasks(const General_options& options,
     {
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
-      Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
-						    new_final_blocker);
+      // Large compressed debug sections are compressed in parallel
+      // before they are written out.
+      Task* t;
+      if (layout->any_compressed_sections())
+	t = new Task_function(new Compress_sections_task_runner(
+				  layout, of, new_final_blocker),
+			      final_blocker,
+			      "Task_function Compress_sections_task_runner");
+      else
+	t = new Write_after_input_sections_task(layout, of, final_blocker,
+						new_final_blocker);
       workqueue->queue(t);
       final_blocker = new_final_blocker;
     }
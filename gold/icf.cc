@@ -167,62 +167,57 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 #include <limits>
 
 namespace gold
 {
 
+// Return the checksum used to compare section contents.  The low 32
+// bits are the CRC32 of the contents, and the high 32 bits are their
+// length, which cheaply separates most sections whose CRC32s collide.
+
+static inline uint64_t
+icf_checksum(const unsigned char* contents, size_t len)
+{
+  uint32_t crc = xcrc32(contents, len, 0xffffffff);
+  return (static_cast<uint64_t>(len) << 32) | crc;
+}
+
+static inline uint64_t
+icf_checksum(const std::string& contents)
+{
+  return icf_checksum(reinterpret_cast<const unsigned char*>(contents.data()),
+                      contents.length());
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// CKSUMS : Vector mapping a section index to the checksum of its
+//          contents, for those sections not already known to be unique.
+//          Before the first iteration of icf, these are the checksums of
+//          the section text.  Later they are the checksums of the
+//          section's text and relocs to sections that cannot be folded.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(const std::vector<uint64_t>& cksums,
+                               std::vector<bool>* is_secn_or_group_unique)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+  Unordered_map<uint64_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint64_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < cksums.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      uniq_map_insert = uniq_map.insert(std::make_pair(cksums[i], i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -290,8 +285,8 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
 //                      functions can be folded. Should normally be the
 //                      same as `secn` except when processing extra identity
 //                      regions.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// TRACKED_RELOCS     : Vector to store the ids of the ICF sections
+//                      pointed to by relocs.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // START_OFFSET       : Only consider the part of the section at and after
 //                      this offset.
@@ -303,7 +298,7 @@ get_section_contents(bool first_iteration,
 		     std::string* fixed_cache,
                      const Section_id& secn,
 		     const Section_id& self_secn,
-                     unsigned int* num_tracked_relocs,
+                     std::vector<unsigned int>* tracked_relocs,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
 		     section_offset_type start_offset = 0,
@@ -443,11 +438,11 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
+              unsigned int secn_id = section_id_map_it->second;
+              if (tracked_relocs)
+                tracked_relocs->push_back(secn_id);
 
               char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
               snprintf(kept_section_str, sizeof(kept_section_str), "%u",
                        kept_section_id[secn_id]);
               if (first_iteration)
@@ -620,7 +615,7 @@ get_section_contents(bool first_iteration,
       std::string external_all =
 	get_section_contents(first_iteration, &external_fixed,
 			     it_ext->second.section, self_secn,
-			     num_tracked_relocs, symtab,
+			     tracked_relocs, symtab,
 			     kept_section_id, it_ext->second.offset,
 			     it_ext->second.offset + it_ext->second.length);
       buffer.append(external_fixed);
@@ -646,117 +641,111 @@ get_section_contents(bool first_iteration,
   return buffer;
 }
 
-// This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
+// This function uses the checksum of each section to detect and form
+// groups of identical sections.  The first iteration does this for all
 // sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
-// two sections with different contents can have the same checksum. Hence,
-// a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// The contents and checksums are computed beforehand by the ICF hash
+// tasks, in parallel, using the kept sections from the start of the
+// iteration.  The contents of a section with relocs to sections folded
+// earlier in this iteration are recomputed here, so that the result is
+// the same as computing them all in order.
+//
+// The checksums can have collisions.  That is, two sections with
+// different contents can have the same checksum.  Hence, a multimap is
+// used to maintain more than one group of checksum identical sections.
+// A section is added to a group only after its contents are explicitly
+// compared with the kept section of the group.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// TRACKED_RELOCS     : The ids of the ICF sections that each section's
+//                      relocs point to.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
+// SECTION_CONTENTS   : The section's text and relocs to non-ICF
+//                      sections.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// FULL_SECTION_CONTENTS : The section's text and relocs for this
+//                         iteration.  Only the contents of the kept
+//                         sections are retained.
+// FULL_CKSUMS        : The checksums of FULL_SECTION_CONTENTS.
 
 static bool
 match_sections(unsigned int iteration_num,
                Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
+               const std::vector<std::vector<unsigned int> >& tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               std::vector<std::string>* section_contents,
+               std::vector<std::string>* full_section_contents,
+               std::vector<uint64_t>* full_cksums)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  Unordered_multimap<uint64_t, unsigned int> section_cksum;
+  std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+            Unordered_multimap<uint64_t, unsigned int>::iterator> key_range;
   bool converged = true;
+  // The sections whose kept section changed in this iteration.
+  std::vector<bool> is_secn_changed(kept_section_id->size(), false);
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
-
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < kept_section_id->size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, secn.first);
-
-      std::string this_secn_contents;
-      uint32_t cksum;
-      std::string* this_secn_cache = &((*section_contents)[i]);
-      if (iteration_num == 1)
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, this_secn_cache,
-						    secn, secn, &num_relocs,
-						    symtab, (*kept_section_id));
-          (*num_tracked_relocs)[i] = num_relocs;
+          // This section is already folded into something.
+          continue;
         }
-      else
+
+      if (!converged)
         {
-          if ((*kept_section_id)[i] != i)
+          const std::vector<unsigned int>& v = tracked_relocs[i];
+          for (std::vector<unsigned int>::const_iterator p = v.begin();
+               p != v.end();
+               ++p)
             {
-              // This section is already folded into something.
-              continue;
+              if (is_secn_changed[*p])
+                {
+                  (*full_section_contents)[i] =
+                    get_section_contents(false, &(*section_contents)[i],
+                                         id_section[i], id_section[i], NULL,
+                                         symtab, *kept_section_id);
+                  (*full_cksums)[i] =
+                    icf_checksum((*full_section_contents)[i]);
+                  break;
+                }
             }
-          this_secn_contents = get_section_contents(false, this_secn_cache,
-						    secn, secn, NULL,
-						    symtab, (*kept_section_id));
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
+      const std::string& this_secn_contents = (*full_section_contents)[i];
+      uint64_t cksum = (*full_cksums)[i];
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
         }
       else
         {
           key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
+          Unordered_multimap<uint64_t, unsigned int>::iterator it;
           // Search all the groups with this cksum for a match.
           for (it = key_range.first; it != key_range.second; ++it)
             {
               unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
+              if ((*full_section_contents)[kept_section].length()
                   != this_secn_contents.length())
                   continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
+              if (memcmp((*full_section_contents)[kept_section].c_str(),
                          this_secn_contents.c_str(),
                          this_secn_contents.length()) != 0)
                   continue;
@@ -770,13 +759,16 @@ match_sections(unsigned int iteration_num,
 	      if (align_i <= align_kept)
 		{
 		  (*kept_section_id)[i] = kept_section;
+		  is_secn_changed[i] = true;
+		  // Only the contents of the kept section are needed.
+		  (*full_section_contents)[i].clear();
 		}
 	      else
 		{
 		  (*kept_section_id)[kept_section] = i;
+		  is_secn_changed[kept_section] = true;
 		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
+		  (*full_section_contents)[kept_section].clear();
 		}
 
               converged = false;
@@ -786,18 +778,17 @@ match_sections(unsigned int iteration_num,
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
             }
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && tracked_relocs[i].empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
   // If a section was folded into another section that was later folded
   // again then the former has to be updated.
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < kept_section_id->size(); i++)
     {
       // Find the end of the folding chain
       unsigned int kept = i;
@@ -943,19 +934,107 @@ Icf::add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
   return true;
 }
 
+// The number of sections handled by each ICF hash task.
+
+const unsigned int icf_hash_task_sections = 1024;
+
+// An Icf_hash_task computes the contents and checksums of a range of
+// sections for one ICF iteration.  These tasks run in parallel.
+
+class Icf_hash_task : public Task
+{
+ public:
+  Icf_hash_task(Icf* icf, Symbol_table* symtab, unsigned int start,
+                unsigned int end, Task_token* blocker)
+    : icf_(icf), symtab_(symtab), start_(start), end_(end), blocker_(blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->icf_->hash_sections(this->symtab_, this->start_, this->end_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  std::string
+  get_name() const
+  { return "Icf_hash_task"; }
+
+ private:
+  Icf* icf_;
+  Symbol_table* symtab_;
+  unsigned int start_;
+  unsigned int end_;
+  Task_token* blocker_;
+};
+
+// An Icf_match_task runs after the Icf_hash_tasks of an iteration,
+// and forms the groups of identical sections.
+
+class Icf_match_task : public Task
+{
+ public:
+  // HASH_BLOCKER is deleted when the task completes.
+  Icf_match_task(Icf* icf, Symbol_table* symtab, Task_token* hash_blocker,
+                 Task_token* icf_blocker)
+    : icf_(icf), symtab_(symtab), hash_blocker_(hash_blocker),
+      icf_blocker_(icf_blocker)
+  { }
+
+  ~Icf_match_task()
+  { delete this->hash_blocker_; }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    this->icf_->match_identical_sections(workqueue, this->symtab_,
+                                         this->icf_blocker_);
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->hash_blocker_->is_blocked())
+      return this->hash_blocker_;
+    return NULL;
+  }
+
+  // Unblock ICF_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->icf_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Icf_match_task"; }
+
+ private:
+  Icf* icf_;
+  Symbol_table* symtab_;
+  Task_token* hash_blocker_;
+  Task_token* icf_blocker_;
+};
+
 // This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (thrice by default)
-// which computes the crc checksums and detects identical functions.
+// initialization and the parts of the first iteration which read the
+// input files, and then queues the tasks which compute the checksums
+// and detect identical functions.  The tasks for each iteration are
+// queued by the match task of the previous one, and run at most thrice
+// by default.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::queue_find_identical_sections(const Task* task, Workqueue* workqueue,
+                                   const Input_objects* input_objects,
+                                   Symbol_table* symtab,
+                                   Task_token* icf_blocker)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -964,11 +1043,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
        p != input_objects->relobj_end();
        ++p)
     {
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, *p);
+      Task_lock_obj<Object> tl(task, *p);
       std::vector<unsigned int> eh_frame_ind;
 
       for (unsigned int i = 0; i < (*p)->shnum(); ++i)
@@ -1001,10 +1076,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+	  this->section_addraligns_.push_back((*p)->section_addralign(i));
           section_num++;
         }
 
@@ -1034,34 +1106,164 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 	}
     }
 
-  unsigned int num_iterations = 0;
+  this->tracked_relocs_.resize(section_num);
+  this->is_secn_or_group_unique_.resize(section_num, false);
+  this->section_contents_.resize(section_num);
+  this->full_section_contents_.resize(section_num);
+  this->fixed_cksums_.resize(section_num, 0);
+  this->full_cksums_.resize(section_num, 0);
 
   // Default number of iterations to run ICF is 3.
-  unsigned int max_iterations = (parameters->options().icf_iterations() > 0)
-                            ? parameters->options().icf_iterations()
-                            : 3;
+  this->max_iterations_ = (parameters->options().icf_iterations() > 0)
+                          ? parameters->options().icf_iterations()
+                          : 3;
+  this->num_iterations_ = 1;
+
+  // The first iteration reads the section contents from the input
+  // files, which can only be done serially.  Before it, find the
+  // sections whose text is unique.
+  for (unsigned int i = 0; i < section_num; i++)
+    {
+      Section_id secn = this->id_section_[i];
+      Task_lock_obj<Object> tl(task, secn.first);
+      section_size_type plen;
+      const unsigned char* contents;
+      contents = secn.first->section_contents(secn.second, &plen, false);
+      this->fixed_cksums_[i] = icf_checksum(contents, plen);
+    }
+  preprocess_for_unique_sections(this->fixed_cksums_,
+                                 &this->is_secn_or_group_unique_);
+
+  for (unsigned int i = 0; i < section_num; i++)
+    {
+      if (this->is_secn_or_group_unique_[i])
+        continue;
+
+      Section_id secn = this->id_section_[i];
+      Task_lock_obj<Object> tl(task, secn.first);
+      this->full_section_contents_[i] =
+        get_section_contents(true, &this->section_contents_[i], secn, secn,
+                             &this->tracked_relocs_[i], symtab,
+                             this->kept_section_id_);
+    }
+
+  this->queue_hash_tasks(workqueue, symtab, icf_blocker);
+}
 
-  bool converged = false;
+// Queue the tasks which compute the section checksums for the
+// current iteration, followed by the task which matches them.
 
-  while (!converged && (num_iterations < max_iterations))
+void
+Icf::queue_hash_tasks(Workqueue* workqueue, Symbol_table* symtab,
+                      Task_token* icf_blocker)
+{
+  Task_token* hash_blocker = new Task_token(true);
+  const unsigned int section_num = this->id_section_.size();
+  for (unsigned int start = 0;
+       start < section_num;
+       start += icf_hash_task_sections)
     {
-      num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+      unsigned int end = std::min(start + icf_hash_task_sections,
+                                  section_num);
+      hash_blocker->add_blocker();
+      workqueue->queue(new Icf_hash_task(this, symtab, start, end,
+                                         hash_blocker));
+    }
+  workqueue->queue(new Icf_match_task(this, symtab, hash_blocker,
+                                      icf_blocker));
+}
+
+// Compute the checksums of the sections with ids from START to END.
+// For the first iteration the section contents were computed by
+// queue_find_identical_sections.  Later iterations do not read the
+// input files, so they can compute the section contents here too.
+// This runs in parallel, and only writes the entries for these
+// sections.
+
+void
+Icf::hash_sections(Symbol_table* symtab, unsigned int start,
+                   unsigned int end)
+{
+  for (unsigned int i = start; i < end; i++)
+    {
+      if (this->is_secn_or_group_unique_[i])
+        continue;
+
+      if (this->num_iterations_ > 1)
+        {
+          this->fixed_cksums_[i] = icf_checksum(this->section_contents_[i]);
+
+          if (this->kept_section_id_[i] != i)
+            {
+              // This section is already folded into something.
+              continue;
+            }
+
+          Section_id secn = this->id_section_[i];
+          this->full_section_contents_[i] =
+            get_section_contents(false, &this->section_contents_[i], secn,
+                                 secn, NULL, symtab, this->kept_section_id_);
+        }
+
+      this->full_cksums_[i] = icf_checksum(this->full_section_contents_[i]);
+    }
+}
+
+// Form groups of identical sections from the checksums.  If that
+// changed anything, queue the next iteration; otherwise finish up.
+
+void
+Icf::match_identical_sections(Workqueue* workqueue, Symbol_table* symtab,
+                              Task_token* icf_blocker)
+{
+  if (this->num_iterations_ > 1)
+    preprocess_for_unique_sections(this->fixed_cksums_,
+                                   &this->is_secn_or_group_unique_);
+
+  bool converged = match_sections(this->num_iterations_, symtab,
+                                  this->tracked_relocs_,
+                                  &this->kept_section_id_,
+                                  this->id_section_,
+                                  this->section_addraligns_,
+                                  &this->is_secn_or_group_unique_,
+                                  &this->section_contents_,
+                                  &this->full_section_contents_,
+                                  &this->full_cksums_);
+
+  // The full contents are recomputed by each iteration.
+  std::vector<std::string>(this->id_section_.size()).swap(
+      this->full_section_contents_);
+
+  if (!converged && this->num_iterations_ < this->max_iterations_)
+    {
+      this->num_iterations_++;
+      // This task releases ICF_BLOCKER when it completes, so add a
+      // blocker for the next match task.  ICF_BLOCKER is already
+      // visible to other tasks, so we need the workqueue lock.
+      workqueue->add_blocker(icf_blocker);
+      this->queue_hash_tasks(workqueue, symtab, icf_blocker);
+      return;
     }
 
   if (parameters->options().print_icf_sections())
     {
       if (converged)
         gold_info(_("%s: ICF Converged after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
       else
         gold_info(_("%s: ICF stopped after %u iteration(s)"),
-                  program_name, num_iterations);
+                  program_name, this->num_iterations_);
     }
 
+  // Free the memory used while iterating.
+  std::vector<std::vector<unsigned int> >().swap(this->tracked_relocs_);
+  std::vector<uint64_t>().swap(this->section_addraligns_);
+  std::vector<bool>().swap(this->is_secn_or_group_unique_);
+  std::vector<std::string>().swap(this->section_contents_);
+  std::vector<std::string>().swap(this->full_section_contents_);
+  std::vector<uint64_t>().swap(this->fixed_cksums_);
+  std::vector<uint64_t>().swap(this->full_cksums_);
+
   // Unfold --keep-unique symbols.
   for (options::String_set::const_iterator p =
 	 parameters->options().keep_unique_begin();
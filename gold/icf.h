@@ -35,6 +35,9 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Task;
+class Task_token;
+class Workqueue;
 
 class Icf
 {
@@ -81,7 +84,11 @@ class Icf
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(),
+    tracked_relocs_(), section_addraligns_(),
+    is_secn_or_group_unique_(), section_contents_(),
+    full_section_contents_(), fixed_cksums_(), full_cksums_(),
+    num_iterations_(0), max_iterations_(0)
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -89,11 +96,28 @@ class Icf
   Section_id
   get_folded_section(Relobj* dup_obj, unsigned int dup_shndx);
 
-  // Forms groups of identical sections where the first member
-  // of each group is the kept section during folding.
+  // Queues the tasks which form groups of identical sections where
+  // the first member of each group is the kept section during
+  // folding.  TASK is the running task.  ICF_BLOCKER must have one
+  // blocker for these tasks, and is unblocked when they are done.
   void
-  find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+  queue_find_identical_sections(const Task* task, Workqueue* workqueue,
+                                const Input_objects* input_objects,
+                                Symbol_table* symtab,
+                                Task_token* icf_blocker);
+
+  // Computes the contents and checksums of the sections with ids
+  // from START to END for the current iteration.  This is called by
+  // the ICF hash tasks, which run in parallel.
+  void
+  hash_sections(Symbol_table* symtab, unsigned int start, unsigned int end);
+
+  // Forms groups of identical sections from the checksums, and
+  // either starts the next iteration or finishes.  This is called by
+  // the ICF match task once the hash tasks are done.
+  void
+  match_identical_sections(Workqueue* workqueue, Symbol_table* symtab,
+                           Task_token* icf_blocker);
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -167,6 +191,12 @@ class Icf
   add_ehframe_links(Relobj* object, unsigned int ehframe_shndx,
 		    Reloc_info& ehframe_relocs);
 
+  // Queues the hash tasks for the current iteration, followed by the
+  // match task.
+  void
+  queue_hash_tasks(Workqueue* workqueue, Symbol_table* symtab,
+                   Task_token* icf_blocker);
+
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
   // Does the reverse.
@@ -186,6 +216,29 @@ class Icf
   // Regions of other sections that should be considered part of
   // each section for ICF purposes.
   Extra_identity_list extra_identity_list_;
+
+  // The following are only used while the ICF tasks run, and are
+  // indexed by section id.
+  // The ids of the sections that might be folded that relocs in
+  // each section point to.
+  std::vector<std::vector<unsigned int> > tracked_relocs_;
+  // The section alignments.
+  std::vector<uint64_t> section_addraligns_;
+  // Whether a section or group of identical sections is already
+  // known to be unique.
+  std::vector<bool> is_secn_or_group_unique_;
+  // The parts of the section contents which do not change from
+  // iteration to iteration.
+  std::vector<std::string> section_contents_;
+  // The full section contents for the current iteration.
+  std::vector<std::string> full_section_contents_;
+  // Checksums of section_contents_ and full_section_contents_.
+  std::vector<uint64_t> fixed_cksums_;
+  std::vector<uint64_t> full_cksums_;
+  // The current iteration, starting at 1.
+  unsigned int num_iterations_;
+  // The maximum number of iterations.
+  unsigned int max_iterations_;
 };
 
 // This function returns true if this section corresponds to a function that
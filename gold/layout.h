@@ -57,6 +57,7 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
 class Gdb_index;
 class Target;
@@ -696,6 +697,12 @@ class Layout
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // Queue the tasks to scan the sections passed to add_to_gdb_index,
+  // if they were deferred.  THIS_BLOCKER is the blocker for the
+  // layout task; return the blocker to use instead.
+  Task_token*
+  queue_gdb_index_tasks(Workqueue*, Task_token* this_blocker);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -851,6 +858,16 @@ class Layout
   any_postprocessing_sections() const
   { return this->any_postprocessing_sections_; }
 
+  // Return whether there are any compressed debug sections.
+  bool
+  any_compressed_sections() const
+  { return !this->compressed_sections_.empty(); }
+
+  // Queue tasks to compress the large compressed debug sections in
+  // parallel.  BLOCKER is unblocked when they are all done.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* blocker);
+
   // Return the size of the output file.
   off_t
   output_file_size() const
@@ -1457,6 +1474,8 @@ class Layout
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The compressed debug sections.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1673,6 +1692,29 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function queues the tasks which compress the large
+// compressed debug sections, followed by a
+// Write_after_input_sections_task which runs when they are done.
+// It runs after all the input sections have been relocated.
+
+class Compress_sections_task_runner : public Task_function_runner
+{
+ public:
+  Compress_sections_task_runner(Layout* layout, Output_file* of,
+				Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
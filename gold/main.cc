@@ -48,6 +48,7 @@
 #include "icf.h"
 #include "incremental.h"
 #include "gdb-index.h"
+#include "parse-cache.h"
 #include "timer.h"
 
 using namespace gold;
@@ -165,7 +166,8 @@ main(int argc, char** argv)
   command_line.process(argc - 1, const_cast<const char**>(argv + 1));
 
   Timer timer;
-  if (command_line.options().stats())
+  if (command_line.options().stats()
+      || command_line.options().user_set_stats_file())
     {
       timer.start();
       set_parameters_timer(&timer);
@@ -254,9 +256,12 @@ main(int argc, char** argv)
   if (command_line.options().print_output_format())
     print_output_format();
 
+  if (command_line.options().stats()
+      || command_line.options().user_set_stats_file())
+    timer.stamp(2);
+
   if (command_line.options().stats())
     {
-      timer.stamp(2);
       Timer::TimeStats elapsed = timer.get_pass_time(0);
       fprintf(stderr,
              _("%s: initial tasks run time: " \
@@ -309,8 +314,18 @@ main(int argc, char** argv)
       layout.print_stats();
       Gdb_index::print_stats();
       Free_list::print_stats();
+      if (command_line.options().user_set_parse_cache())
+	Parse_cache::print_stats();
     }
 
+  if (command_line.options().user_set_stats_file())
+    workqueue.task_stats()->write_json(command_line.options().stats_file(),
+				       &timer, layout.output_file_size());
+
+  if (command_line.options().user_set_task_trace_file())
+    workqueue.task_trace()->write_json(
+	command_line.options().task_trace_file());
+
   // Issue defined symbol report.
   if (command_line.options().user_set_print_symbol_counts())
     input_objects.print_symbol_counts(&symtab);
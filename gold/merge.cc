@@ -477,18 +477,32 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 
   // Count the number of non-null strings in the section and size the list.
   size_t count = 0;
+  size_t all_count = 0;
   const Char_type* pt = p;
   while (pt < pend0)
     {
       size_t len = string_length(pt);
       if (len != 0)
 	++count;
+      ++all_count;
       pt += len + 1;
     }
   if (pend0 < pend)
-    ++count;
+    {
+      ++count;
+      ++all_count;
+    }
   merged_strings.reserve(count + 1);
 
+  // If the Read_symbols task already hashed the strings, use those
+  // hash codes.  J is the index of the next one.  Hash codes read from
+  // a --parse-cache file for a different version of the section are
+  // ignored.
+  const std::vector<size_t>* hashes = object->merge_string_hashes(shndx);
+  if (hashes != NULL && hashes->size() != all_count)
+    hashes = NULL;
+  size_t j = 0;
+
   // The index I is in bytes, not characters.
   section_size_type i = 0;
 
@@ -510,13 +524,22 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	  has_misaligned_strings = true;
 
       Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      if (hashes != NULL)
+	{
+	  this->stringpool_.add_with_length_and_hash(p, len, (*hashes)[j],
+						     true, &key);
+	  ++j;
+	}
+      else
+	this->stringpool_.add_with_length(p, len, true, &key);
 
       merged_strings.push_back(Merged_string(i, key));
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
 
+  gold_assert(hashes == NULL || j == hashes->size());
+
   // Record the last offset in the input section so that we can
   // compute the length of the last string.
   merged_strings.push_back(Merged_string(i, 0));
@@ -540,6 +563,33 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   return true;
 }
 
+// Compute the hash codes of the strings in a mergeable string
+// section.
+
+template<typename Char_type>
+void
+hash_merge_strings(const unsigned char* pdata, section_size_type len,
+		   std::vector<size_t>* hashes)
+{
+  if (len % sizeof(Char_type) != 0)
+    return;
+
+  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
+  const Char_type* pend = p + len / sizeof(Char_type);
+
+  // Find the end of the last NULL-terminated string in the buffer.
+  const Char_type* pend0 = pend;
+  while (pend0 > p && pend0[-1] != 0)
+    --pend0;
+
+  while (p < pend)
+    {
+      size_t slen = p < pend0 ? string_length(p) : pend - p;
+      hashes->push_back(gold::string_hash<Char_type>(p, slen));
+      p += slen + 1;
+    }
+}
+
 // Finalize the mappings from the input sections to the output
 // section, and return the final data size.
 
@@ -670,6 +720,21 @@ class Output_merge_string<uint16_t>;
 template
 class Output_merge_string<uint32_t>;
 
+template
+void
+hash_merge_strings<char>(const unsigned char*, section_size_type,
+			 std::vector<size_t>*);
+
+template
+void
+hash_merge_strings<uint16_t>(const unsigned char*, section_size_type,
+			     std::vector<size_t>*);
+
+template
+void
+hash_merge_strings<uint32_t>(const unsigned char*, section_size_type,
+			     std::vector<size_t>*);
+
 #if defined(HAVE_TARGET_32_LITTLE) || defined(HAVE_TARGET_32_BIG)
 template
 void
@@ -396,6 +396,18 @@ class Output_merge_data : public Output_merge_base
 // Handle SHF_MERGE sections with string data.  This is a template
 // based on the type of the characters in the string.
 
+// Compute the hash code of each string in the contents PDATA, of
+// LEN bytes, of a mergeable string section, and append them to
+// *HASHES.  The strings are split up in the same way as in
+// Output_merge_string<Char_type>::do_add_input_section.  This is
+// called from the Read_symbols task, which may run in parallel with
+// other tasks.
+
+template<typename Char_type>
+void
+hash_merge_strings(const unsigned char* pdata, section_size_type len,
+		   std::vector<size_t>* hashes);
+
 template<typename Char_type>
 class Output_merge_string : public Output_merge_base
 {
@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "parse-cache.h"
 
 namespace gold
 {
@@ -920,6 +921,181 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // With --parse-cache, compute the hash codes even without threads,
+  // since Add_symbols uses them either way.
+  if (parameters->options().user_set_parse_cache())
+    {
+      // Identify the contents by the build ID, if there is one.
+      const unsigned char* build_id = NULL;
+      section_size_type build_id_size = 0;
+      const char* names =
+	reinterpret_cast<const char*>(sd->section_names->data());
+      const unsigned char* p = pshdrs + This::shdr_size;
+      for (unsigned int i = 1; i < this->shnum(); ++i, p += This::shdr_size)
+	{
+	  typename This::Shdr shdr(p);
+	  if (shdr.get_sh_type() == elfcpp::SHT_NOTE
+	      && shdr.get_sh_name() < sd->section_names_size
+	      && strcmp(names + shdr.get_sh_name(), ".note.gnu.build-id") == 0)
+	    {
+	      build_id = this->section_contents(i, &build_id_size, false);
+	      break;
+	    }
+	}
+
+      Parse_cache cache(this, sd, this->shnum() * This::shdr_size, sym_size,
+			build_id, build_id_size);
+      size_t symcount = (extsize / sym_size);
+      Merge_string_hash_map* merge_string_hashes;
+      if (cache.read(symcount, &sd->global_symbol_names,
+		     &merge_string_hashes))
+	{
+	  if (merge_string_hashes != NULL)
+	    this->set_merge_string_hashes(merge_string_hashes);
+	}
+      else
+	{
+	  this->hash_global_symbol_names(sd);
+	  this->hash_merge_string_sections(sd);
+	  cache.write(sd->global_symbol_names,
+		      this->merge_string_hash_map());
+	}
+    }
+  else if (parameters->options().threads())
+    {
+      this->hash_global_symbol_names(sd);
+      this->hash_merge_string_sections(sd);
+    }
+}
+
+// Compute the length and hash code of the name of each external
+// symbol.  This is called from the Read_symbols task, which may run
+// in parallel with other Read_symbols tasks, so that the serial
+// Add_symbols task does not have to hash the names itself.  The
+// length stops at any '@', matching the version handling in
+// Symbol_table::add_from_relobj.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::hash_global_symbol_names(
+    Read_symbols_data* sd)
+{
+  const int sym_size = This::sym_size;
+  size_t symcount = ((sd->symbols_size - sd->external_symbols_offset)
+		     / sym_size);
+  const unsigned char* p = sd->symbols->data() + sd->external_symbols_offset;
+  const char* sym_names =
+    reinterpret_cast<const char*>(sd->symbol_names->data());
+
+  sd->global_symbol_names.resize(symcount);
+  for (size_t i = 0; i < symcount; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+      Global_symbol_name* gsn = &sd->global_symbol_names[i];
+      unsigned int st_name = sym.get_st_name();
+      if (st_name >= sd->symbol_names_size)
+	{
+	  // add_from_relobj will report the error.
+	  gsn->length = 0;
+	  gsn->hash_code = 0;
+	  continue;
+	}
+      const char* name = sym_names + st_name;
+      const char* ver = strchr(name, '@');
+      gsn->length = ver != NULL ? ver - name : strlen(name);
+      gsn->hash_code = gold::string_hash<char>(name, gsn->length);
+    }
+}
+
+// Compute the hash codes of the strings in each section which will
+// be passed to an Output_merge_string, so that the serial Add_symbols
+// task can add them to the string pool without hashing them.  The
+// conditions here follow Output_section::add_input_section; any
+// section which is not merged after all just wastes a little work.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::hash_merge_string_sections(
+    Read_symbols_data* sd)
+{
+  if (parameters->incremental())
+    return;
+
+  const bool strip_debug = (parameters->options().strip_debug()
+			    || parameters->options().strip_debug_non_line()
+			    || parameters->options().strip_debug_gdb());
+  const unsigned char* const pshdrs = sd->section_headers->data();
+  const char* names =
+    reinterpret_cast<const char*>(sd->section_names->data());
+  Compressed_section_map* compressed_sections = this->compressed_sections();
+  Merge_string_hash_map* merge_string_hashes = NULL;
+
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < this->shnum(); ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      if (shdr.get_sh_type() != elfcpp::SHT_PROGBITS
+	  || shdr.get_sh_size() == 0
+	  || shdr.get_sh_name() >= sd->section_names_size)
+	continue;
+
+      const char* name = names + shdr.get_sh_name();
+      elfcpp::Elf_Xword flags = shdr.get_sh_flags();
+      uint64_t entsize = shdr.get_sh_entsize();
+      if (strcmp(name, ".debug_str") == 0
+	  || strcmp(name, ".zdebug_str") == 0)
+	{
+	  flags |= elfcpp::SHF_MERGE | elfcpp::SHF_STRINGS;
+	  entsize = 1;
+	}
+      if ((flags & elfcpp::SHF_MERGE) == 0
+	  || (flags & elfcpp::SHF_STRINGS) == 0
+	  || (strip_debug && (flags & elfcpp::SHF_ALLOC) == 0))
+	continue;
+
+      // Only use the decompressed contents of a compressed section if
+      // they have already been decompressed.
+      const unsigned char* contents;
+      section_size_type len;
+      Compressed_section_map::const_iterator pc;
+      if (compressed_sections != NULL
+	  && ((pc = compressed_sections->find(i))
+	      != compressed_sections->end()))
+	{
+	  if (pc->second.contents == NULL)
+	    continue;
+	  contents = pc->second.contents;
+	  len = pc->second.size;
+	}
+      else
+	contents = this->section_contents(i, &len, false);
+
+      std::vector<size_t> hashes;
+      switch (entsize)
+	{
+	case 1:
+	  hash_merge_strings<char>(contents, len, &hashes);
+	  break;
+	case 2:
+	  hash_merge_strings<uint16_t>(contents, len, &hashes);
+	  break;
+	case 4:
+	  hash_merge_strings<uint32_t>(contents, len, &hashes);
+	  break;
+	default:
+	  break;
+	}
+      if (hashes.empty())
+	continue;
+
+      if (merge_string_hashes == NULL)
+	merge_string_hashes = new Merge_string_hash_map();
+      (*merge_string_hashes)[i].swap(hashes);
+    }
+
+  if (merge_string_hashes != NULL)
+    this->set_merge_string_hashes(merge_string_hashes);
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -2148,6 +2324,9 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  (sd->global_symbol_names.empty()
+			   ? NULL
+			   : &sd->global_symbol_names[0]),
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2155,6 +2334,7 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  std::vector<Global_symbol_name>().swap(sd->global_symbol_names);
 }
 
 // Find out if this object, that is a member of a lib group, should be included
@@ -54,6 +54,16 @@ struct Symbols_data;
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// The name of an external symbol, as precomputed by read_symbols().
+// LENGTH is the length of the name up to any '@' version separator,
+// and HASH_CODE is the Stringpool hash code of those characters.
+
+struct Global_symbol_name
+{
+  size_t length;
+  size_t hash_code;
+};
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
@@ -83,6 +93,11 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // The names of the external symbols, in symbol table order.  This
+  // is filled in when running with threads, so that the names are
+  // hashed by the parallel Read_symbols tasks rather than in the
+  // serial Add_symbols tasks.  Empty if the names were not hashed.
+  std::vector<Global_symbol_name> global_symbol_names;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -380,6 +395,11 @@ struct Compressed_section_info
 };
 typedef std::map<unsigned int, Compressed_section_info> Compressed_section_map;
 
+// Type for mapping section index to the hash codes of the strings in
+// a mergeable string section, in section order.
+
+typedef std::map<unsigned int, std::vector<size_t> > Merge_string_hash_map;
+
 template<int size, bool big_endian>
 Compressed_section_map*
 build_compressed_section_map(const unsigned char* pshdrs, unsigned int shnum,
@@ -446,7 +466,7 @@ class Object
       is_dynamic_(is_dynamic), is_needed_(false), uses_split_stack_(false),
       has_no_split_stack_(false), no_export_(false),
       is_in_system_directory_(false), as_needed_(false), xindex_(NULL),
-      compressed_sections_(NULL)
+      compressed_sections_(NULL), merge_string_hashes_(NULL)
   {
     if (input_file != NULL)
       {
@@ -882,6 +902,30 @@ class Object
   void
   discard_decompressed_sections();
 
+  // Return the hash codes of the strings in the mergeable string
+  // section SHNDX, as computed when the symbols were read, or NULL if
+  // they were not computed.
+  const std::vector<size_t>*
+  merge_string_hashes(unsigned int shndx) const
+  {
+    if (this->merge_string_hashes_ == NULL)
+      return NULL;
+    Merge_string_hash_map::const_iterator p =
+      this->merge_string_hashes_->find(shndx);
+    if (p == this->merge_string_hashes_->end())
+      return NULL;
+    return &p->second;
+  }
+
+  // Discard the hash codes of the strings in mergeable string
+  // sections.  This is done at the end of the Add_symbols task.
+  void
+  discard_merge_string_hashes()
+  {
+    delete this->merge_string_hashes_;
+    this->merge_string_hashes_ = NULL;
+  }
+
   // Return the index of the first incremental relocation for symbol SYMNDX.
   unsigned int
   get_incremental_reloc_base(unsigned int symndx) const
@@ -1095,6 +1139,14 @@ class Object
   compressed_sections()
   { return this->compressed_sections_; }
 
+  void
+  set_merge_string_hashes(Merge_string_hash_map* merge_string_hashes)
+  { this->merge_string_hashes_ = merge_string_hashes; }
+
+  const Merge_string_hash_map*
+  merge_string_hash_map() const
+  { return this->merge_string_hashes_; }
+
  private:
   // This class may not be copied.
   Object(const Object&);
@@ -1132,6 +1184,9 @@ class Object
   // For compressed debug sections, map section index to uncompressed size
   // and contents.
   Compressed_section_map* compressed_sections_;
+  // For mergeable string sections, map section index to the hash codes
+  // of the strings, when they were computed by the Read_symbols task.
+  Merge_string_hash_map* merge_string_hashes_;
 };
 
 // A regular object (ET_REL).  This is an abstract base class itself.
@@ -2387,6 +2442,16 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   base_read_symbols(Read_symbols_data*);
 
+  // Compute the lengths and hash codes of the names of the external
+  // symbols in SD.
+  void
+  hash_global_symbol_names(Read_symbols_data* sd);
+
+  // Compute the hash codes of the strings in the mergeable string
+  // sections.
+  void
+  hash_merge_string_sections(Read_symbols_data* sd);
+
   // Return the value of a local symbol.
   uint64_t
   do_local_symbol_value(unsigned int symndx, uint64_t addend) const
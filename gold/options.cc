@@ -1340,6 +1340,15 @@ General_options::finalize()
 	}
     }
 
+  // The --parse-cache directory must already exist.
+  if (this->user_set_parse_cache())
+    {
+      struct stat st;
+      if (::stat(this->parse_cache(), &st) != 0 || !S_ISDIR(st.st_mode))
+	gold_fatal(_("--parse-cache: %s is not a directory"),
+		   this->parse_cache());
+    }
+
   // -Bgroup implies --unresolved-symbols=report-all.
   if (this->Bgroup() && !this->user_set_unresolved_symbols())
     this->set_unresolved_symbols("report-all");
@@ -1433,6 +1442,12 @@ General_options::finalize()
 	}
     }
 
+#ifndef HAVE_ZSTD
+  if (strcmp(this->compress_debug_sections(), "zstd") == 0)
+    gold_fatal(_("--compress-debug-sections=zstd: gold is not built "
+		 "with zstd support"));
+#endif
+
   // --rosegment-gap implies --rosegment.
   if (this->user_set_rosegment_gap())
     this->set_rosegment(true);
@@ -770,8 +770,8 @@ class General_options
 
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
 	      N_("Compress .debug_* sections in the output file"),
-	      ("[none,zlib,zlib-gnu,zlib-gabi]"), false,
-	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
+	      ("[none,zlib,zlib-gnu,zlib-gabi,zstd]"), false,
+	      {"none", "zlib", "zlib-gnu", "zlib-gabi", "zstd"});
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -1099,6 +1099,10 @@ class General_options
 
   // p
 
+  DEFINE_string(parse_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache the symbol and string hash codes of input objects "
+		   "in DIR"), N_("DIR"));
+
   DEFINE_bool(p, options::ONE_DASH, 'p', false,
 	      N_("Ignored for ARM compatibility"), NULL);
 
@@ -1285,6 +1289,10 @@ class General_options
 
   DEFINE_bool(stats, options::TWO_DASHES, '\0', false,
 	      N_("Print resource usage statistics"), NULL);
+  DEFINE_string(stats_file, options::TWO_DASHES, '\0', NULL,
+		N_("Write resource usage statistics for each pass, task "
+		   "class and thread to FILE in JSON format"),
+		N_("FILE"));
 
   DEFINE_string(sysroot, options::TWO_DASHES, '\0', "",
 		N_("Set target system root directory"), N_("DIR"));
@@ -1305,6 +1313,11 @@ class General_options
 	      N_("[rel, abs, got-rel"), false,
 	      {"rel", "abs", "got-rel"});
 
+  DEFINE_string(task_trace_file, options::TWO_DASHES, '\0', NULL,
+		N_("Write a trace of the tasks run by the linker to FILE "
+		   "in Chrome trace event format"),
+		N_("FILE"));
+
   DEFINE_bool(text_reorder, options::TWO_DASHES, '\0', true,
 	      N_("Enable text section reordering for GCC section names"),
 	      N_("Disable text section reordering for GCC section names"));
@@ -1702,6 +1715,15 @@ class General_options
   set_incremental_disposition(Incremental_disposition disp)
   { this->incremental_disposition_ = disp; }
 
+  // Turn on multi-threading.  This is for programs other than the
+  // linker, such as dwp, which do not parse a linker command line.
+  void
+  enable_threads()
+  {
+    this->set_threads(true);
+    this->set_user_set_threads();
+  }
+
   // The disposition to use for startup files (those that precede the
   // first --incremental-changed, etc. option).
   Incremental_disposition
@@ -0,0 +1,407 @@
+// parse-cache.cc -- on-disk cache of input object data for gold
+
+// Copyright (C) 2022 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "parameters.h"
+#include "options.h"
+#include "fileread.h"
+#include "gold-threads.h"
+#include "binary-io.h"
+#include "elfcpp_swap.h"
+#include "parse-cache.h"
+
+namespace gold
+{
+
+// The first word of a cache file.  Change this if the format changes.
+static const char parse_cache_magic[8] =
+  { 'G', 'O', 'L', 'D', 'P', 'C', '0', '2' };
+
+// A lock for the statistics.
+static Lock* parse_cache_lock = NULL;
+static Initialize_lock parse_cache_initialize_lock(&parse_cache_lock);
+
+// Class Parse_cache.
+
+unsigned long long Parse_cache::hits;
+unsigned long long Parse_cache::misses;
+unsigned long long Parse_cache::writes;
+
+// Increment a statistics counter.
+
+static void
+count(unsigned long long* counter)
+{
+  parse_cache_initialize_lock.initialize();
+  Hold_optional_lock hl(parse_cache_lock);
+  ++*counter;
+}
+
+// Read LEN bytes from DESCRIPTOR into BUF.  Return false on error or
+// end of file.
+
+static bool
+read_all(int descriptor, void* buf, size_t len)
+{
+  char* p = static_cast<char*>(buf);
+  while (len > 0)
+    {
+      ssize_t got = ::read(descriptor, p, len);
+      if (got < 0 && errno == EINTR)
+	continue;
+      if (got <= 0)
+	return false;
+      p += got;
+      len -= got;
+    }
+  return true;
+}
+
+// Write LEN bytes from BUF to DESCRIPTOR.  Return false on error.
+
+static bool
+write_all(int descriptor, const void* buf, size_t len)
+{
+  const char* p = static_cast<const char*>(buf);
+  while (len > 0)
+    {
+      ssize_t written = ::write(descriptor, p, len);
+      if (written < 0 && errno == EINTR)
+	continue;
+      if (written <= 0)
+	return false;
+      p += written;
+      len -= written;
+    }
+  return true;
+}
+
+// Return a checksum of the LEN bytes at P, starting from H.  This
+// reads a word at a time, so that it costs much less than hashing the
+// strings it covers.
+
+static uint64_t
+checksum(uint64_t h, const unsigned char* p, size_t len)
+{
+  const uint64_t prime = 0x100000001b3ULL;
+  h = (h ^ len) * prime;
+  for (; len >= 8; p += 8, len -= 8)
+    {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      h = (h ^ w) * prime;
+      h ^= h >> 29;
+    }
+  for (; len > 0; ++p, --len)
+    h = (h ^ *p) * prime;
+  return h;
+}
+
+// Work out the cache file name and key for OBJECT.  If we can't stat
+// the file, the object is not cached.
+
+Parse_cache::Parse_cache(Relobj* object, const Read_symbols_data* sd,
+			 size_t shdrs_size, size_t sym_size,
+			 const unsigned char* build_id, size_t build_id_size)
+  : object_(object),
+    symbols_(sd->symbols->data() + sd->external_symbols_offset),
+    symbols_size_(sd->symbols_size - sd->external_symbols_offset),
+    sym_size_(sym_size),
+    symbol_names_(reinterpret_cast<const char*>(sd->symbol_names->data())),
+    symbol_names_size_(sd->symbol_names_size),
+    has_build_id_(build_id != NULL),
+    filename_(), dev_(0), ino_(0), offset_(0), size_(0),
+    mtime_sec_(0), mtime_nsec_(0), shdrs_checksum_(0), contents_checksum_(0)
+{
+  struct stat st;
+  if (::fstat(object->input_file()->file().descriptor(), &st) < 0)
+    return;
+
+  this->dev_ = st.st_dev;
+  this->ino_ = st.st_ino;
+  this->offset_ = object->offset();
+  this->size_ = st.st_size;
+  this->mtime_sec_ = st.st_mtime;
+#ifdef HAVE_STAT_ST_MTIM
+  this->mtime_nsec_ = st.st_mtim.tv_nsec;
+#endif
+  this->shdrs_checksum_ = checksum(0, sd->section_headers->data(),
+				   shdrs_size);
+  if (build_id != NULL)
+    this->contents_checksum_ = checksum(1, build_id, build_id_size);
+  else
+    {
+      uint64_t h = checksum(2, this->symbols_, this->symbols_size_);
+      this->contents_checksum_ =
+	checksum(h, sd->symbol_names->data(), this->symbol_names_size_);
+    }
+
+  char buf[100];
+  snprintf(buf, sizeof buf, "/%llx-%llx-%llx",
+	   static_cast<unsigned long long>(this->dev_),
+	   static_cast<unsigned long long>(this->ino_),
+	   static_cast<unsigned long long>(this->offset_));
+  this->filename_ = parameters->options().parse_cache();
+  this->filename_ += buf;
+}
+
+// Fill in the cache file header.
+
+void
+Parse_cache::make_header(uint64_t* header, size_t symcount,
+			 size_t nsections) const
+{
+  memcpy(&header[0], parse_cache_magic, sizeof parse_cache_magic);
+  header[1] = 0x0102030405060708ULL;
+  header[2] = sizeof(size_t);
+  header[3] = this->dev_;
+  header[4] = this->ino_;
+  header[5] = this->offset_;
+  header[6] = this->size_;
+  header[7] = this->mtime_sec_;
+  header[8] = this->mtime_nsec_;
+  header[9] = this->shdrs_checksum_;
+  header[10] = this->contents_checksum_;
+  header[11] = symcount;
+  header[12] = nsections;
+}
+
+// Check the symbol name lengths read from the cache file, so that a
+// bad one can never make Symbol_table::add_from_relobj read past the
+// end of the symbol names.  Each name must end at a '\0' or '@', and
+// a symbol whose name is out of range must have a length of 0, as
+// hash_global_symbol_names records it.
+
+bool
+Parse_cache::check_names(const std::vector<Global_symbol_name>& names) const
+{
+  const bool big_endian = this->object_->is_big_endian();
+  const unsigned char* p = this->symbols_;
+  for (size_t i = 0; i < names.size(); ++i, p += this->sym_size_)
+    {
+      // The st_name field is the first word of both ELF32 and ELF64
+      // symbols.
+      size_t st_name = (big_endian
+			? elfcpp::Swap_unaligned<32, true>::readval(p)
+			: elfcpp::Swap_unaligned<32, false>::readval(p));
+      size_t length = names[i].length;
+      if (st_name >= this->symbol_names_size_)
+	{
+	  if (length != 0)
+	    return false;
+	  continue;
+	}
+      if (length >= this->symbol_names_size_ - st_name)
+	return false;
+      char c = this->symbol_names_[st_name + length];
+      if (c != '\0' && c != '@')
+	return false;
+    }
+  return true;
+}
+
+// Return the checksum of the contents of section SHNDX.  With a build
+// ID there is no need for it.
+
+uint64_t
+Parse_cache::section_checksum(unsigned int shndx) const
+{
+  if (this->has_build_id_)
+    return 0;
+  section_size_type len;
+  const unsigned char* contents =
+    this->object_->section_contents(shndx, &len, false);
+  return checksum(3, contents, len);
+}
+
+// Try to read the data for the object from the cache file.
+
+bool
+Parse_cache::read(size_t symcount, std::vector<Global_symbol_name>* names,
+		  Merge_string_hash_map** merge_string_hashes)
+{
+  if (this->filename_.empty())
+    return false;
+
+  int o = ::open(this->filename_.c_str(), O_RDONLY | O_BINARY);
+  if (o < 0)
+    {
+      count(&misses);
+      return false;
+    }
+
+  std::vector<uint64_t> buf;
+  struct stat st;
+  bool ok = (::fstat(o, &st) == 0
+	     && st.st_size % sizeof(uint64_t) == 0
+	     && static_cast<size_t>(st.st_size) >= header_words * 8);
+  if (ok)
+    {
+      buf.resize(st.st_size / sizeof(uint64_t));
+      ok = read_all(o, &buf[0], st.st_size);
+    }
+  ::close(o);
+
+  // Check that the header matches, leaving the section count to be
+  // taken from the file.
+  if (ok)
+    {
+      uint64_t header[header_words];
+      this->make_header(header, symcount, buf[header_words - 1]);
+      ok = memcmp(header, &buf[0], sizeof header) == 0;
+    }
+
+  // Check the sizes as we go, in case the file was truncated.
+  size_t n = buf.size();
+  size_t pos = header_words;
+  if (ok)
+    ok = (symcount <= (n - pos) / 2
+	  && symcount * this->sym_size_ <= this->symbols_size_);
+  if (!ok)
+    {
+      count(&misses);
+      return false;
+    }
+
+  names->resize(symcount);
+  for (size_t i = 0; i < symcount; ++i, pos += 2)
+    {
+      (*names)[i].length = buf[pos];
+      (*names)[i].hash_code = buf[pos + 1];
+    }
+  ok = this->check_names(*names);
+
+  // Each section has at most one string per byte.  Output_merge_string
+  // checks the exact count before using the hash codes.
+  Merge_string_hash_map* hashes = NULL;
+  uint64_t nsections = buf[header_words - 1];
+  for (uint64_t i = 0; ok && i < nsections; ++i)
+    {
+      if (n - pos < 3
+	  || buf[pos] == 0
+	  || buf[pos] >= this->object_->shnum()
+	  || buf[pos + 1] > n - pos - 3
+	  || buf[pos + 1] > this->object_->section_size(buf[pos])
+	  || buf[pos + 2] != this->section_checksum(buf[pos]))
+	{
+	  ok = false;
+	  break;
+	}
+      unsigned int shndx = buf[pos];
+      size_t strcount = buf[pos + 1];
+      pos += 3;
+      if (hashes == NULL)
+	hashes = new Merge_string_hash_map();
+      std::vector<size_t>& v((*hashes)[shndx]);
+      v.assign(buf.begin() + pos, buf.begin() + pos + strcount);
+      pos += strcount;
+    }
+  if (!ok || pos != n)
+    {
+      delete hashes;
+      std::vector<Global_symbol_name>().swap(*names);
+      count(&misses);
+      return false;
+    }
+
+  *merge_string_hashes = hashes;
+  count(&hits);
+  return true;
+}
+
+// Write the data computed for the object to the cache file.  Write a
+// temporary file and rename it, so that other links running at the
+// same time never see a partial file.  Errors are ignored: the cache
+// is only an optimization.
+
+void
+Parse_cache::write(const std::vector<Global_symbol_name>& names,
+		   const Merge_string_hash_map* merge_string_hashes)
+{
+  if (this->filename_.empty())
+    return;
+
+  size_t nsections = (merge_string_hashes == NULL
+		      ? 0
+		      : merge_string_hashes->size());
+  std::vector<uint64_t> buf(header_words);
+  this->make_header(&buf[0], names.size(), nsections);
+
+  for (size_t i = 0; i < names.size(); ++i)
+    {
+      buf.push_back(names[i].length);
+      buf.push_back(names[i].hash_code);
+    }
+
+  if (merge_string_hashes != NULL)
+    {
+      for (Merge_string_hash_map::const_iterator p =
+	     merge_string_hashes->begin();
+	   p != merge_string_hashes->end();
+	   ++p)
+	{
+	  buf.push_back(p->first);
+	  buf.push_back(p->second.size());
+	  buf.push_back(this->section_checksum(p->first));
+	  buf.insert(buf.end(), p->second.begin(), p->second.end());
+	}
+    }
+
+  char suffix[100];
+  snprintf(suffix, sizeof suffix, ".%ld.%p.tmp",
+	   static_cast<long>(::getpid()), static_cast<void*>(this->object_));
+  std::string tmpname = this->filename_ + suffix;
+
+  int o = ::open(tmpname.c_str(),
+		 O_WRONLY | O_CREAT | O_EXCL | O_TRUNC | O_BINARY, 0644);
+  if (o < 0)
+    return;
+  bool ok = write_all(o, &buf[0], buf.size() * sizeof(uint64_t));
+  if (::close(o) < 0)
+    ok = false;
+  if (ok && ::rename(tmpname.c_str(), this->filename_.c_str()) == 0)
+    count(&writes);
+  else
+    ::unlink(tmpname.c_str());
+}
+
+// Print statistics about the cache.
+
+void
+Parse_cache::print_stats()
+{
+  fprintf(stderr, _("%s: parse cache hits: %llu\n"),
+	  program_name, Parse_cache::hits);
+  fprintf(stderr, _("%s: parse cache misses: %llu\n"),
+	  program_name, Parse_cache::misses);
+  fprintf(stderr, _("%s: parse cache files written: %llu\n"),
+	  program_name, Parse_cache::writes);
+}
+
+} // End namespace gold.
@@ -0,0 +1,133 @@
+// parse-cache.h -- on-disk cache of input object data for gold  -*- C++ -*-
+
+// Copyright (C) 2022 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_PARSE_CACHE_H
+#define GOLD_PARSE_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace gold
+{
+
+// An on-disk cache, used with the --parse-cache option, of the data
+// which the Read_symbols task computes from a relocatable object: the
+// lengths and hash codes of the global symbol names, and the hash
+// codes of the strings in the mergeable string sections.  When an
+// unchanged object is linked again, this data is read back instead of
+// being recomputed.
+
+// There is one cache file per input object, named after the device
+// and inode of the file and the offset of the archive member, if any.
+// A cache file is only used if the size and modification time of the
+// file, a checksum of the ELF section headers, and the contents of the
+// object match the ones recorded when it was written.  The contents
+// are identified by the .note.gnu.build-id section if there is one,
+// and otherwise by checksums of the symbol table, the symbol names and
+// each mergeable string section, since an object may be rewritten in
+// place without changing its size or modification time.  Everything
+// read from a cache file is checked against the object before it is
+// used, and any mismatch makes the lookup a miss.  A cache file is an
+// array of 64-bit words in host byte order, so it may be read or
+// mapped directly.  Cache files are never removed by the linker.
+
+class Parse_cache
+{
+ public:
+  // OBJECT is the object being read, and SD holds the data read from
+  // it so far.  SHDRS_SIZE is the size of its section headers, and
+  // SYM_SIZE the size of a symbol table entry.  BUILD_ID points to the
+  // BUILD_ID_SIZE bytes of its .note.gnu.build-id section, or is NULL.
+  Parse_cache(Relobj* object, const Read_symbols_data* sd, size_t shdrs_size,
+	      size_t sym_size, const unsigned char* build_id,
+	      size_t build_id_size);
+
+  // Try to read the data for the object from the cache.  SYMCOUNT is
+  // the number of global symbols.  On success, fill in *NAMES and
+  // *MERGE_STRING_HASHES, which is set to NULL if there are no
+  // mergeable string sections, and return true.
+  bool
+  read(size_t symcount, std::vector<Global_symbol_name>* names,
+       Merge_string_hash_map** merge_string_hashes);
+
+  // Write the data computed for the object to the cache.
+  // MERGE_STRING_HASHES may be NULL.
+  void
+  write(const std::vector<Global_symbol_name>& names,
+	const Merge_string_hash_map* merge_string_hashes);
+
+  // Print statistics about the cache to stderr.
+  static void
+  print_stats();
+
+ private:
+  // The number of words in the cache file header.
+  static const size_t header_words = 13;
+
+  // Fill in the cache file header.
+  void
+  make_header(uint64_t* header, size_t symcount, size_t nsections) const;
+
+  // Return whether the symbol name lengths in NAMES fit the object's
+  // symbol names.
+  bool
+  check_names(const std::vector<Global_symbol_name>& names) const;
+
+  // Return the checksum of the contents of section SHNDX, or 0 if the
+  // object has a build ID.
+  uint64_t
+  section_checksum(unsigned int shndx) const;
+
+  // The object.
+  Relobj* object_;
+  // The external symbols of the object, and their size.
+  const unsigned char* symbols_;
+  size_t symbols_size_;
+  size_t sym_size_;
+  // The symbol names of the object, and their size.
+  const char* symbol_names_;
+  size_t symbol_names_size_;
+  // Whether the object has a build ID.
+  bool has_build_id_;
+  // The name of the cache file, or empty if the object can't be
+  // cached.
+  std::string filename_;
+  // The key recorded in the cache file header.
+  uint64_t dev_;
+  uint64_t ino_;
+  uint64_t offset_;
+  uint64_t size_;
+  uint64_t mtime_sec_;
+  uint64_t mtime_nsec_;
+  uint64_t shdrs_checksum_;
+  uint64_t contents_checksum_;
+
+  // Statistics.
+  static unsigned long long hits;
+  static unsigned long long misses;
+  static unsigned long long writes;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_PARSE_CACHE_H)
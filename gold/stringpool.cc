@@ -241,6 +241,28 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  Hashkey hk(s, length);
+  return this->add_hashkey(hk, copy, pkey);
+}
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_length_and_hash(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    bool copy,
+    Key* pkey)
+{
+  Hashkey hk(s, length, hash_code);
+  return this->add_hashkey(hk, copy, pkey);
+}
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_hashkey(Hashkey& hk, bool copy,
+						  Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
@@ -252,7 +274,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(hk, k);
 
       Insert_type ins = this->string_set_.insert(element);
 
@@ -262,7 +284,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 	{
 	  // We just added the string.  The key value has now been
 	  // used.
-	  this->new_key_offset(length);
+	  this->new_key_offset(hk.length);
 	}
       else
 	{
@@ -279,7 +301,6 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
   typename String_set_type::const_iterator p = this->string_set_.find(hk);
   if (p != this->string_set_.end())
     {
@@ -288,9 +309,9 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       return p->first.string;
     }
 
-  this->new_key_offset(length);
+  this->new_key_offset(hk.length);
 
-  hk.string = this->add_string(s, length);
+  hk.string = this->add_string(hk.string, hk.length);
   // The contents of the string stay the same, so we don't need to
   // adjust hk.hash_code or hk.length.
 
@@ -0,0 +1,44 @@
+// parse_cache_test.c -- a test case for gold --parse-cache
+
+// Copyright (C) 2022 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The test rewrites the string and the function name below in place,
+// keeping the size and modification time of the object.
+
+#include <stdio.h>
+
+const char *
+parse_cache_string (void)
+{
+  return "parse cache string 1";
+}
+
+int
+parse_cache_fn_1 (void)
+{
+  return 1;
+}
+
+int
+main (void)
+{
+  puts (parse_cache_string ());
+  return parse_cache_fn_1 () == 1 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# parse_cache_test.sh -- test the --parse-cache option.
+
+# Copyright (C) 2022 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# parse_cache_test_1 and parse_cache_test_2 were linked with the same
+# --parse-cache directory.  The second link should have found every
+# input object in the cache, and produced the same output.
+
+if ! cmp -s parse_cache_test_1 parse_cache_test_2; then
+    echo "parse_cache_test_1 and parse_cache_test_2 differ"
+    exit 1
+fi
+
+if ! grep -q "parse cache hits: [1-9]" parse_cache_test.err; then
+    echo "no parse cache hits in parse_cache_test.err"
+    cat parse_cache_test.err
+    exit 1
+fi
+
+if ! grep -q "parse cache misses: 0$" parse_cache_test.err; then
+    echo "unexpected parse cache misses in parse_cache_test.err"
+    cat parse_cache_test.err
+    exit 1
+fi
+
+# parse_cache_test_3 was linked twice with the same --parse-cache
+# directory, from an object which was rewritten in place in between,
+# keeping its size and modification time.  The second link should have
+# missed the cache for it, and used the new strings.
+
+if ! grep -q "parse cache misses: [1-9]" parse_cache_test_3.err; then
+    echo "no parse cache misses in parse_cache_test_3.err"
+    cat parse_cache_test_3.err
+    exit 1
+fi
+
+if ! grep -q "parse cache string 2" parse_cache_test_3; then
+    echo "parse_cache_test_3 does not contain the new string"
+    exit 1
+fi
+
+if ! grep -q " parse_cache_fn_2$" parse_cache_test_3.stdout; then
+    echo "parse_cache_test_3 does not define the new symbol"
+    cat parse_cache_test_3.stdout
+    exit 1
+fi
+
+exit 0
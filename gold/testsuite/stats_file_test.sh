@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# stats_file_test.sh -- test the --stats-file option.
+
+# Copyright (C) 2022 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Check that the statistics written by --stats-file include the
+# passes and the tasks which are run for every link.
+
+check()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -z "$found"; then
+        echo "pattern \"$pattern\" not found in file $file."
+        exit 1
+    fi
+}
+
+check stats_file_test.json '"name": "initial"'
+check stats_file_test.json '"name": "final"'
+check stats_file_test.json '"peak_rss_kb": [0-9]'
+check stats_file_test.json '"class": "Read_symbols", "count": [1-9]'
+check stats_file_test.json '"class": "Relocate_task", "count": [1-9]'
+check stats_file_test.json '"class": "Layout_task_runner", "count": 1,'
+check stats_file_test.json '"thread": 0, "tasks": [1-9]'
+
+exit 0
@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# task_trace_test.sh -- test the --task-trace-file option.
+
+# Copyright (C) 2022 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Check that the trace written by --task-trace-file has a slice for
+# the tasks which are run for every link, and that tasks which waited
+# for a blocker are linked to the task which released it.
+
+check()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -z "$found"; then
+        echo "pattern \"$pattern\" not found in file $file."
+        exit 1
+    fi
+}
+
+check task_trace_test.json '"traceEvents"'
+check task_trace_test.json '"name": "thread_name", "ph": "M"'
+check task_trace_test.json '"cat": "Read_symbols", "ph": "X"'
+check task_trace_test.json '"cat": "Relocate_task", "ph": "X"'
+check task_trace_test.json '"waited_on": '
+check task_trace_test.json '"unblocked_by": '
+check task_trace_test.json '"ph": "s"'
+check task_trace_test.json '"ph": "f", "bp": "e"'
+
+exit 0
@@ -22,14 +22,26 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstring>
+#include <ctime>
 #include <unistd.h>
 
 #ifdef HAVE_TIMES
 #include <sys/times.h>
 #endif
 
+#ifdef HAVE_GETTIMEOFDAY
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_GETRUSAGE
+#include <sys/resource.h>
+#endif
+
 #include "libiberty.h"
 
+#include "gold-threads.h"
 #include "timer.h"
 
 namespace gold
@@ -130,4 +142,394 @@ Timer::get_pass_time(int n)
   return thispass;
 }
 
+// Class Task_stats.
+
+Task_stats::Task_stats()
+  : lock_(new Lock()), classes_(), threads_(), start_(wall_time())
+{
+}
+
+Task_stats::~Task_stats()
+{
+  delete this->lock_;
+}
+
+// Return the current wall clock time in microseconds.
+
+long long
+Task_stats::wall_time()
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  if (::gettimeofday(&tv, NULL) == 0)
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+#endif
+  return ::time(NULL) * 1000000LL;
+}
+
+// Take a snapshot of the resource usage of the current thread.  When
+// the system can't report the usage of a single thread, this reports
+// the usage of the whole process.
+
+void
+Task_stats::sample(Sample* s)
+{
+  s->wall = wall_time();
+  s->user = 0;
+  s->sys = 0;
+  s->maxrss = 0;
+#ifdef HAVE_GETRUSAGE
+  struct rusage ru;
+#ifdef RUSAGE_THREAD
+  int who = RUSAGE_THREAD;
+#else
+  int who = RUSAGE_SELF;
+#endif
+  if (::getrusage(who, &ru) == 0)
+    {
+      s->user = ru.ru_utime.tv_sec * 1000000LL + ru.ru_utime.tv_usec;
+      s->sys = ru.ru_stime.tv_sec * 1000000LL + ru.ru_stime.tv_usec;
+      s->maxrss = ru.ru_maxrss;
+    }
+#endif
+}
+
+// Return the task class for a task name.  By convention a task name
+// starts with the name of the Task class, followed by a space and the
+// object it works on.  Task_function tasks are named by their runner.
+
+std::string
+Task_stats::task_class(const std::string& task_name)
+{
+  std::string::size_type pos = task_name.find(' ');
+  if (pos == std::string::npos)
+    return task_name;
+  if (task_name.compare(0, pos, "Task_function") != 0)
+    return task_name.substr(0, pos);
+  std::string::size_type end = task_name.find(' ', pos + 1);
+  if (end == std::string::npos)
+    return task_name.substr(pos + 1);
+  return task_name.substr(pos + 1, end - (pos + 1));
+}
+
+// Return the statistics for thread THREAD_NUMBER.
+
+Task_stats::Thread_stats&
+Task_stats::thread_stats(int thread_number)
+{
+  gold_assert(thread_number >= 0);
+  size_t n = thread_number;
+  if (n >= this->threads_.size())
+    this->threads_.resize(n + 1);
+  return this->threads_[n];
+}
+
+// Record the time spent waiting for a task.
+
+void
+Task_stats::record_wait(int thread_number, long long wait)
+{
+  Hold_lock hl(*this->lock_);
+  this->thread_stats(thread_number).wait += wait;
+}
+
+// Record a task which was run.
+
+void
+Task_stats::record_task(int thread_number, const std::string& task_name,
+			const Sample& start, const Sample& end)
+{
+  std::string cls = task_class(task_name);
+  long long wall = end.wall - start.wall;
+
+  Hold_lock hl(*this->lock_);
+
+  Class_stats& cs(this->classes_[cls]);
+  ++cs.count;
+  cs.wall += wall;
+  if (wall > cs.max_wall)
+    cs.max_wall = wall;
+  cs.user += end.user - start.user;
+  cs.sys += end.sys - start.sys;
+  if (end.maxrss > cs.maxrss)
+    cs.maxrss = end.maxrss;
+  if (end.maxrss > start.maxrss)
+    cs.rss_growth += end.maxrss - start.maxrss;
+
+  Thread_stats& ts(this->thread_stats(thread_number));
+  ++ts.tasks;
+  ts.run += wall;
+  ts.user += end.user - start.user;
+  ts.sys += end.sys - start.sys;
+}
+
+// Write S to F as a JSON string.
+
+static void
+write_json_string(FILE* f, const char* s)
+{
+  putc('"', f);
+  for (; *s != '\0'; ++s)
+    {
+      unsigned char c = *s;
+      if (c == '"' || c == '\\')
+	fprintf(f, "\\%c", c);
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write the statistics to FILENAME in JSON format.  Times are in
+// milliseconds for the passes, which come from Timer, and in
+// microseconds for tasks and threads.  Memory sizes are in kilobytes.
+
+void
+Task_stats::write_json(const char* filename, Timer* timer,
+		       long long output_file_size)
+{
+  FILE* f = ::fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open stats file %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  Hold_lock hl(*this->lock_);
+
+  Sample now;
+  sample(&now);
+
+  fprintf(f, "{\n  \"program\": ");
+  write_json_string(f, program_name);
+  fprintf(f, ",\n  \"output_file_size\": %lld,\n", output_file_size);
+  fprintf(f, "  \"peak_rss_kb\": %ld,\n", now.maxrss);
+  fprintf(f, "  \"wall_us\": %lld,\n", now.wall - this->start_);
+
+  static const char* const pass_names[] = { "initial", "middle", "final" };
+  fprintf(f, "  \"passes\": [\n");
+  for (int i = 0; i < 3; ++i)
+    {
+      Timer::TimeStats t = timer->get_pass_time(i);
+      fprintf(f, "    { \"name\": \"%s\", \"user_ms\": %ld, "
+	      "\"sys_ms\": %ld, \"wall_ms\": %ld }%s\n",
+	      pass_names[i], t.user, t.sys, t.wall, i < 2 ? "," : "");
+    }
+  Timer::TimeStats total = timer->get_elapsed_time();
+  fprintf(f, "  ],\n  \"total\": { \"user_ms\": %ld, \"sys_ms\": %ld, "
+	  "\"wall_ms\": %ld },\n",
+	  total.user, total.sys, total.wall);
+
+  fprintf(f, "  \"tasks\": [");
+  const char* sep = "\n";
+  for (Class_map::const_iterator p = this->classes_.begin();
+       p != this->classes_.end();
+       ++p)
+    {
+      const Class_stats& cs(p->second);
+      fprintf(f, "%s    { \"class\": ", sep);
+      write_json_string(f, p->first.c_str());
+      fprintf(f, ", \"count\": %lld, \"wall_us\": %lld, "
+	      "\"max_wall_us\": %lld, \"user_us\": %lld, \"sys_us\": %lld, "
+	      "\"peak_rss_kb\": %ld, \"rss_growth_kb\": %ld }",
+	      cs.count, cs.wall, cs.max_wall, cs.user, cs.sys, cs.maxrss,
+	      cs.rss_growth);
+      sep = ",\n";
+    }
+  fprintf(f, "\n  ],\n");
+
+  fprintf(f, "  \"threads\": [");
+  sep = "\n";
+  for (size_t i = 0; i < this->threads_.size(); ++i)
+    {
+      const Thread_stats& ts(this->threads_[i]);
+      fprintf(f, "%s    { \"thread\": %lu, \"tasks\": %lld, "
+	      "\"run_us\": %lld, \"wait_us\": %lld, \"user_us\": %lld, "
+	      "\"sys_us\": %lld }",
+	      sep, static_cast<unsigned long>(i), ts.tasks, ts.run, ts.wait,
+	      ts.user, ts.sys);
+      sep = ",\n";
+    }
+  fprintf(f, "\n  ]\n}\n");
+
+  if (::fclose(f) != 0)
+    gold_error(_("cannot close stats file %s: %s"), filename,
+	       strerror(errno));
+}
+
+// Class Task_trace.
+
+Task_trace::Task_trace()
+  : lock_(new Lock()), pending_(), finished_(), events_(),
+    start_(Task_stats::wall_time())
+{
+}
+
+Task_trace::~Task_trace()
+{
+  delete this->lock_;
+}
+
+// Note that a task has been queued.
+
+void
+Task_trace::task_queued(const Task* t)
+{
+  long long now = Task_stats::wall_time();
+  Hold_lock hl(*this->lock_);
+  Pending& p(this->pending_[t]);
+  p = Pending();
+  p.queued = now;
+}
+
+// Note that a task is waiting for a token.
+
+void
+Task_trace::task_blocked(const Task* t, const Task_token* token)
+{
+  long long now = Task_stats::wall_time();
+  Hold_lock hl(*this->lock_);
+  Pending& p(this->pending_[t]);
+  if (p.blocked < 0)
+    p.blocked = now;
+  p.token = token;
+}
+
+// Note that a task may run because another task released a token.
+
+void
+Task_trace::task_unblocked(const Task* t, const Task_token* token,
+			   const Task* releaser)
+{
+  Hold_lock hl(*this->lock_);
+  Pending& p(this->pending_[t]);
+  p.token = token;
+  Finished_map::const_iterator f = this->finished_.find(releaser);
+  p.unblocked_by = f != this->finished_.end() ? f->second : -1;
+}
+
+// Record a task which was run.
+
+void
+Task_trace::record_task(int thread_number, const Task* t,
+			const std::string& task_name, long long start,
+			long long end)
+{
+  Hold_lock hl(*this->lock_);
+  Event e;
+  e.name = task_name;
+  e.thread_number = thread_number;
+  e.start = start;
+  e.end = end;
+  Pending_map::iterator p = this->pending_.find(t);
+  if (p != this->pending_.end())
+    {
+      e.pending = p->second;
+      this->pending_.erase(p);
+    }
+  this->finished_[t] = this->events_.size();
+  this->events_.push_back(e);
+}
+
+// Note that a task is being deleted, so its address may be reused.
+
+void
+Task_trace::task_done(const Task* t)
+{
+  Hold_lock hl(*this->lock_);
+  this->finished_.erase(t);
+}
+
+// Write the trace to FILENAME.  Times in the trace event format are
+// in microseconds.
+
+void
+Task_trace::write_json(const char* filename)
+{
+  FILE* f = ::fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open task trace file %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  Hold_lock hl(*this->lock_);
+
+  long pid = ::getpid();
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(f, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %ld, "
+	  "\"args\": {\"name\": ", pid);
+  write_json_string(f, program_name);
+  fprintf(f, "}}");
+
+  std::vector<bool> seen_threads;
+  for (size_t i = 0; i < this->events_.size(); ++i)
+    {
+      size_t n = this->events_[i].thread_number;
+      if (n >= seen_threads.size())
+	seen_threads.resize(n + 1);
+      if (!seen_threads[n])
+	{
+	  fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+		  "\"pid\": %ld, \"tid\": %lu, "
+		  "\"args\": {\"name\": \"workqueue thread %lu\"}}",
+		  pid, static_cast<unsigned long>(n),
+		  static_cast<unsigned long>(n));
+	  seen_threads[n] = true;
+	}
+    }
+
+  for (size_t i = 0; i < this->events_.size(); ++i)
+    {
+      const Event& e(this->events_[i]);
+      const Pending& p(e.pending);
+
+      fprintf(f, ",\n{\"name\": ");
+      write_json_string(f, e.name.c_str());
+      fprintf(f, ", \"cat\": ");
+      write_json_string(f, Task_stats::task_class(e.name).c_str());
+      fprintf(f, ", \"ph\": \"X\", \"ts\": %lld, \"dur\": %lld, "
+	      "\"pid\": %ld, \"tid\": %d, \"args\": {\"queued_us\": %lld",
+	      e.start - this->start_, e.end - e.start, pid, e.thread_number,
+	      e.start - p.queued);
+      if (p.blocked >= 0)
+	fprintf(f, ", \"blocked_us\": %lld", e.start - p.blocked);
+      if (p.token != NULL)
+	fprintf(f, ", \"waited_on\": \"%p\"", static_cast<const void*>(p.token));
+      if (p.unblocked_by >= 0)
+	{
+	  fprintf(f, ", \"unblocked_by\": ");
+	  write_json_string(f, this->events_[p.unblocked_by].name.c_str());
+	}
+      fprintf(f, "}}");
+
+      // Draw an arrow from the end of the task which released the
+      // token to the start of this task.
+      if (p.unblocked_by >= 0)
+	{
+	  const Event& r(this->events_[p.unblocked_by]);
+	  fprintf(f, ",\n{\"name\": \"unblock\", \"cat\": \"token\", "
+		  "\"ph\": \"s\", \"id\": %lu, \"ts\": %lld, \"pid\": %ld, "
+		  "\"tid\": %d}",
+		  static_cast<unsigned long>(i), r.end - this->start_, pid,
+		  r.thread_number);
+	  fprintf(f, ",\n{\"name\": \"unblock\", \"cat\": \"token\", "
+		  "\"ph\": \"f\", \"bp\": \"e\", \"id\": %lu, \"ts\": %lld, "
+		  "\"pid\": %ld, \"tid\": %d}",
+		  static_cast<unsigned long>(i), e.start - this->start_, pid,
+		  e.thread_number);
+	}
+    }
+
+  fprintf(f, "\n]}\n");
+
+  if (::fclose(f) != 0)
+    gold_error(_("cannot close task trace file %s: %s"), filename,
+	       strerror(errno));
+}
+
 }
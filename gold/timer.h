@@ -23,9 +23,18 @@
 #ifndef GOLD_TIMER_H
 #define GOLD_TIMER_H
 
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
 namespace gold
 {
 
+class Lock;
+class Task;
+class Task_token;
+
 class Timer
 {
  public:
@@ -76,5 +85,212 @@ class Timer
   TimeStats pass_times_[3];
 };
 
+// Resource usage statistics for the tasks run by the workqueue,
+// grouped by task class and by workqueue thread.  This is used for
+// the --stats-file option.
+
+class Task_stats
+{
+ public:
+  // A snapshot of the resource usage of the current thread.  The
+  // times are in microseconds.
+  struct Sample
+  {
+    // Wall clock time.
+    long long wall;
+    // User time in this thread.
+    long long user;
+    // System time in this thread.
+    long long sys;
+    // Peak resident set size of the process, in kilobytes.
+    long maxrss;
+  };
+
+  Task_stats();
+
+  ~Task_stats();
+
+  // Take a snapshot of the resource usage of the current thread.
+  static void
+  sample(Sample*);
+
+  // Return the current wall clock time in microseconds.
+  static long long
+  wall_time();
+
+  // Return the task class for a task name.
+  static std::string
+  task_class(const std::string& task_name);
+
+  // Record that thread THREAD_NUMBER waited WAIT microseconds to find
+  // a task to run.
+  void
+  record_wait(int thread_number, long long wait);
+
+  // Record that thread THREAD_NUMBER ran the task named TASK_NAME.
+  // START and END are the resource usage before and after running it.
+  void
+  record_task(int thread_number, const std::string& task_name,
+	      const Sample& start, const Sample& end);
+
+  // Write the statistics to FILENAME in JSON format.  TIMER holds the
+  // times for each pass.
+  void
+  write_json(const char* filename, Timer* timer,
+	     long long output_file_size);
+
+ private:
+  // This class cannot be copied.
+  Task_stats(const Task_stats&);
+  Task_stats& operator=(const Task_stats&);
+
+  // Statistics for a task class.
+  struct Class_stats
+  {
+    Class_stats()
+      : count(0), wall(0), max_wall(0), user(0), sys(0), maxrss(0),
+	rss_growth(0)
+    { }
+
+    // Number of tasks run.
+    long long count;
+    // Total and maximum wall clock time of a task.
+    long long wall;
+    long long max_wall;
+    // Total user and system time.
+    long long user;
+    long long sys;
+    // Largest peak RSS seen when a task finished.
+    long maxrss;
+    // Total growth of the peak RSS while running tasks.
+    long rss_growth;
+  };
+
+  // Statistics for a workqueue thread.
+  struct Thread_stats
+  {
+    Thread_stats()
+      : tasks(0), run(0), wait(0), user(0), sys(0)
+    { }
+
+    // Number of tasks run.
+    long long tasks;
+    // Total wall clock time spent running tasks.
+    long long run;
+    // Total wall clock time spent waiting for a runnable task,
+    // including waiting for the workqueue lock.
+    long long wait;
+    // Total user and system time spent running tasks.
+    long long user;
+    long long sys;
+  };
+
+  typedef std::map<std::string, Class_stats> Class_map;
+
+  // Return the statistics for thread THREAD_NUMBER.  The lock must be
+  // held.
+  Thread_stats&
+  thread_stats(int thread_number);
+
+  // Lock controlling access to the remaining members.
+  Lock* lock_;
+  // Statistics for each task class.
+  Class_map classes_;
+  // Statistics for each thread.
+  std::vector<Thread_stats> threads_;
+  // Wall clock time when the statistics were started.
+  long long start_;
+};
+
+// A trace of the tasks run by the workqueue, written in the Chrome
+// trace event format which chrome://tracing and Perfetto can load.
+// Each task is shown as a slice on the thread which ran it.  When a
+// task had to wait for a Task_token, the trace records the token and
+// draws a flow arrow from the task which released it.  This is used
+// for the --task-trace-file option.
+
+class Task_trace
+{
+ public:
+  Task_trace();
+
+  ~Task_trace();
+
+  // Note that task T has been added to the workqueue.
+  void
+  task_queued(const Task* t);
+
+  // Note that task T is waiting for TOKEN.
+  void
+  task_blocked(const Task* t, const Task_token* token);
+
+  // Note that task T may now run, because task RELEASER released
+  // TOKEN.
+  void
+  task_unblocked(const Task* t, const Task_token* token,
+		 const Task* releaser);
+
+  // Record that thread THREAD_NUMBER ran task T, named TASK_NAME,
+  // from START to END, which are wall clock times in microseconds.
+  void
+  record_task(int thread_number, const Task* t,
+	      const std::string& task_name, long long start, long long end);
+
+  // Note that task T has released its locks and is being deleted.
+  void
+  task_done(const Task* t);
+
+  // Write the trace to FILENAME.
+  void
+  write_json(const char* filename);
+
+ private:
+  // This class cannot be copied.
+  Task_trace(const Task_trace&);
+  Task_trace& operator=(const Task_trace&);
+
+  // The state of a task which has been queued but not yet run.
+  struct Pending
+  {
+    Pending()
+      : queued(0), blocked(-1), token(NULL), unblocked_by(-1)
+    { }
+
+    // When the task was queued.
+    long long queued;
+    // When the task first waited for a token, or -1.
+    long long blocked;
+    // The last token the task waited for, or NULL.
+    const Task_token* token;
+    // The event index of the task which released that token, or -1.
+    long unblocked_by;
+  };
+
+  // A task which has been run.
+  struct Event
+  {
+    std::string name;
+    int thread_number;
+    long long start;
+    long long end;
+    Pending pending;
+  };
+
+  typedef std::map<const Task*, Pending> Pending_map;
+  typedef std::map<const Task*, long> Finished_map;
+
+  // Lock controlling access to the remaining members.
+  Lock* lock_;
+  // Tasks which have been queued but not yet run.
+  Pending_map pending_;
+  // Tasks which have been run but not yet deleted, mapped to their
+  // index in events_.
+  Finished_map finished_;
+  // Tasks which have been run.
+  std::vector<Event> events_;
+  // Wall clock time when the trace was started.
+  long long start_;
+};
+
 }
 #endif
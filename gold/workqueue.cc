@@ -123,7 +123,9 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    task_stats_(NULL),
+    task_trace_(NULL)
 {
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
@@ -139,10 +141,17 @@ Workqueue::Workqueue(const General_options& options)
       gold_unreachable();
 #endif
     }
+
+  if (options.user_set_stats_file())
+    this->task_stats_ = new Task_stats();
+  if (options.user_set_task_trace_file())
+    this->task_trace_ = new Task_trace();
 }
 
 Workqueue::~Workqueue()
 {
+  delete this->task_stats_;
+  delete this->task_trace_;
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -153,6 +162,9 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->task_trace_ != NULL)
+    this->task_trace_->task_queued(t);
+
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
@@ -161,6 +173,8 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
       else
 	token->add_waiting(t);
       ++this->waiting_;
+      if (this->task_trace_ != NULL)
+	this->task_trace_->task_blocked(t, token);
     }
   else
     {
@@ -224,6 +238,8 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
 
       token->add_waiting(t);
       ++this->waiting_;
+      if (this->task_trace_ != NULL)
+	this->task_trace_->task_blocked(t, token);
     }
 
   // We couldn't find any runnable task.
@@ -290,6 +306,12 @@ Workqueue::find_and_run_task(int thread_number)
 {
   Task* t;
   Task_locker tl;
+  Task_stats* stats = this->task_stats_;
+  Task_trace* trace = this->task_trace_;
+
+  long long wait_start = 0;
+  if (stats != NULL)
+    wait_start = Task_stats::wall_time();
 
   {
     Hold_lock hl(this->lock_);
@@ -297,16 +319,22 @@ Workqueue::find_and_run_task(int thread_number)
     // Find a runnable task.
     t = this->find_runnable_or_wait(thread_number);
 
-    if (t == NULL)
-      return false;
-
-    // Get the locks for the task.  This must be called while we are
-    // still holding the Workqueue lock.
-    t->locks(&tl);
+    if (t != NULL)
+      {
+	// Get the locks for the task.  This must be called while we
+	// are still holding the Workqueue lock.
+	t->locks(&tl);
 
-    ++this->running_;
+	++this->running_;
+      }
   }
 
+  if (stats != NULL)
+    stats->record_wait(thread_number, Task_stats::wall_time() - wait_start);
+
+  if (t == NULL)
+    return false;
+
   while (t != NULL)
     {
       gold_debug(DEBUG_TASK, "%3d running   task %s", thread_number,
@@ -316,8 +344,29 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      // Get the task name before running the task, since the name
+      // may refer to objects which the task frees.
+      Task_stats::Sample start;
+      long long trace_start = 0;
+      if (stats != NULL || trace != NULL)
+	t->name();
+      if (stats != NULL)
+	Task_stats::sample(&start);
+      if (trace != NULL)
+	trace_start = Task_stats::wall_time();
+
       t->run(this);
 
+      if (trace != NULL)
+	trace->record_task(thread_number, t, t->name(), trace_start,
+			   Task_stats::wall_time());
+      if (stats != NULL)
+	{
+	  Task_stats::Sample end;
+	  Task_stats::sample(&end);
+	  stats->record_task(thread_number, t->name(), start, end);
+	}
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -356,6 +405,8 @@ Workqueue::find_and_run_task(int thread_number)
       }
 
       // We are done with this task.
+      if (trace != NULL)
+	trace->task_done(t);
       delete t;
 
       t = next;
@@ -402,6 +453,8 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     {
       token->add_waiting(t);
       ++this->waiting_;
+      if (this->task_trace_ != NULL)
+	this->task_trace_->task_blocked(t, token);
       return false;
     }
 
@@ -456,11 +509,13 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	    {
 	      // The token has been unblocked.  Every waiting Task may
 	      // now be runnable.
-	      Task* t;
-	      while ((t = token->remove_first_waiting()) != NULL)
+	      Task* w;
+	      while ((w = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  if (this->task_trace_ != NULL)
+		    this->task_trace_->task_unblocked(w, token, t);
+		  this->return_or_queue(w, true, &ret);
 		}
 	    }
 	}
@@ -473,11 +528,13 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  // move all the Tasks to the runnable queue, to avoid a
 	  // potential deadlock if the locking status changes before
 	  // we run the next thread.
-	  Task* t;
-	  while ((t = token->remove_first_waiting()) != NULL)
+	  Task* w;
+	  while ((w = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->task_trace_ != NULL)
+		this->task_trace_->task_unblocked(w, token, t);
+	      if (this->return_or_queue(w, false, &ret))
 		break;
 	    }
 	}
@@ -36,6 +36,8 @@ namespace gold
 {
 
 class General_options;
+class Task_stats;
+class Task_trace;
 class Workqueue;
 
 // The superclass for tasks to be placed on the workqueue.  Each
@@ -233,6 +235,18 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Return the task statistics, or NULL if they are not being
+  // collected.  They are collected for the --stats-file option.
+  Task_stats*
+  task_stats() const
+  { return this->task_stats_; }
+
+  // Return the task trace, or NULL if tasks are not being traced.
+  // They are traced for the --task-trace-file option.
+  Task_trace*
+  task_trace() const
+  { return this->task_trace_; }
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -288,6 +302,10 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+  // Statistics about the tasks which have been run, or NULL.
+  Task_stats* task_stats_;
+  // A trace of the tasks which have been run, or NULL.
+  Task_trace* task_trace_;
 };
 
 } // End namespace gold.